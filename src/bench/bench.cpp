@@ -0,0 +1,94 @@
+#include "bench.h"
+#include <fstream>
+#include <iostream>
+
+void Bench::write(std::ostream& os) const {
+	auto percentile = [](const vector<double>& sorted, double p) -> double { return sorted[std::min(sizet(double(sorted.size()) * p), sorted.size() - 1)]; };
+	os << "{\n\"benchmarks\": [";
+	for (sizet i = 0; i < results.size(); ++i) {
+		const Result& it = results[i];
+		vector<double> sorted = it.samples;
+		std::sort(sorted.begin(), sorted.end());
+		double total = std::accumulate(sorted.begin(), sorted.end(), 0.0) / 1000.0;
+		os << (i ? ",\n" : "\n") << "{\"name\": \"" << it.name << "\", \"iterations\": " << sorted.size()
+			<< ", \"mean_ms\": " << toStr(total * 1000.0 / double(sorted.size()))
+			<< ", \"p50_ms\": " << toStr(percentile(sorted, 0.5))
+			<< ", \"p90_ms\": " << toStr(percentile(sorted, 0.9))
+			<< ", \"p99_ms\": " << toStr(percentile(sorted, 0.99))
+			<< ", \"max_ms\": " << toStr(sorted.back());
+		if (it.work.items)
+			os << ", \"items_per_s\": " << toStr(total > 0.0 ? double(it.work.items) / total : 0.0);
+		if (it.work.bytes)
+			os << ", \"mb_per_s\": " << toStr(total > 0.0 ? double(it.work.bytes) / total / 1'000'000.0 : 0.0);
+		os << '}';
+	}
+	os << "\n],\n\"peak_rss_bytes\": " << peakMemory() << "\n}\n";
+}
+
+uint64 Bench::fileSize(const fs::path& path) {
+	std::error_code ec;
+	uintmax_t size = fs::file_size(path, ec);
+	return !ec ? size : 0;
+}
+
+uint64 Bench::dirSize(const fs::path& drc) {
+	uint64 size = 0;
+	std::error_code ec;
+	for (const fs::directory_entry& it : fs::directory_iterator(drc, ec))
+		if (it.is_regular_file(ec))
+			size += fileSize(it.path());
+	return size;
+}
+
+int main(int argc, char** argv) {
+	fs::path corpus = fs::temp_directory_path() / "vertiread_bench";
+	fs::path output;
+	string filter;
+	bool keep = false;
+	bool software = true;
+	for (int i = 1; i < argc; ++i) {
+		if (string_view arg = argv[i]; arg == "--corpus" && i + 1 < argc) {
+			corpus = fs::u8path(argv[++i]);
+			keep = true;
+		} else if (arg == "--out" && i + 1 < argc)
+			output = fs::u8path(argv[++i]);
+		else if (arg == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if (arg == "--keep")
+			keep = true;
+		else if (arg == "--hardware")
+			software = false;
+		else {
+			std::cerr << "usage: " << argv[0] << " [--corpus <dir>] [--keep] [--filter <name>] [--hardware] [--out <file>]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	SDL_SetMainReady();
+	if (SDL_Init(SDL_INIT_EVENTS)) {
+		std::cerr << SDL_GetError() << std::endl;
+		return EXIT_FAILURE;
+	}
+	int rc = EXIT_SUCCESS;
+	try {
+		Bench bench(std::move(filter));
+		benchLoaders(bench, corpus);
+		benchRenderers(bench, corpus, software);
+		benchUi(bench, corpus);
+		if (output.empty())
+			bench.write(std::cout);
+		else if (std::ofstream ofs(output, std::ios::binary); ofs)
+			bench.write(ofs);
+		else
+			throw std::runtime_error("Failed to open " + output.u8string());
+	} catch (const std::runtime_error& e) {
+		std::cerr << e.what() << std::endl;
+		rc = EXIT_FAILURE;
+	}
+	if (!keep) {
+		std::error_code ec;
+		fs::remove_all(corpus, ec);
+	}
+	SDL_Quit();
+	return rc;
+}
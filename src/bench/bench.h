@@ -0,0 +1,77 @@
+#pragma once
+
+#include "utils/utils.h"
+#include <numeric>
+
+// times benchmark cases and writes their results out as JSON
+class Bench {
+public:
+	struct Work {
+		uint64 items = 0;	// pages, names, etc. processed by one iteration
+		uint64 bytes = 0;
+	};
+
+private:
+	struct Result {
+		string name;
+		vector<double> samples;	// milliseconds per iteration
+		Work work;				// total of all iterations
+	};
+
+	vector<Result> results;
+	string filter;	// only run cases whose name contains this
+
+public:
+	Bench(string nameFilter);
+
+	bool wants(const string& name) const;
+	template <class F> void run(string name, uint iterations, F func);
+	void add(string name, vector<double>&& samples, Work work);	// for cases that need untimed work between iterations
+	void write(std::ostream& os) const;
+
+	static double elapsedMs(uint64 start);
+
+	static uint64 fileSize(const fs::path& path);
+	static uint64 dirSize(const fs::path& drc);
+};
+
+inline Bench::Bench(string nameFilter) :
+	filter(std::move(nameFilter))
+{}
+
+inline bool Bench::wants(const string& name) const {
+	return filter.empty() || name.find(filter) != string::npos;
+}
+
+template <class F>
+void Bench::run(string name, uint iterations, F func) {
+	if (!wants(name))
+		return;
+
+	vector<double> samples(iterations);
+	Work total;
+	for (uint i = 0; i < iterations; ++i) {
+		uint64 start = SDL_GetPerformanceCounter();
+		Work work = func();
+		samples[i] = elapsedMs(start);
+		total.items += work.items;
+		total.bytes += work.bytes;
+	}
+	add(std::move(name), std::move(samples), total);
+}
+
+inline void Bench::add(string name, vector<double>&& samples, Work work) {
+	if (samples.empty())
+		return;
+	logInfo(name, ": ", toStr(std::accumulate(samples.begin(), samples.end(), 0.0) / double(samples.size())), " ms");
+	results.push_back(Result{ std::move(name), std::move(samples), work });
+}
+
+inline double Bench::elapsedMs(uint64 start) {
+	return double(SDL_GetPerformanceCounter() - start) * 1000.0 / double(SDL_GetPerformanceFrequency());
+}
+
+// benchmark groups
+void benchLoaders(Bench& bench, const fs::path& corpus);
+void benchRenderers(Bench& bench, const fs::path& corpus, bool software);
+void benchUi(Bench& bench, const fs::path& corpus);	// runs the program and therefore has to go last
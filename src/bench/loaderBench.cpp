@@ -0,0 +1,233 @@
+#include "bench.h"
+#include "engine/drawSys.h"
+#include "engine/fileSys.h"
+#include "engine/renderer.h"
+#include "utils/compare.h"
+#include <archive.h>
+#include <archive_entry.h>
+#include <fstream>
+#include <random>
+#ifdef _WIN32
+#include <SDL_image.h>
+#else
+#include <SDL2/SDL_image.h>
+#endif
+
+namespace {
+
+struct PageSet {
+	const char* name;
+	ivec2 res;
+	uint pages;
+};
+
+struct ArchiveType {
+	const char* ext;
+	int (*setFormat)(archive*);
+};
+
+constexpr array<PageSet, 3> pageSets = {
+	PageSet{ "small", ivec2(800, 1200), 48 },
+	PageSet{ "medium", ivec2(1600, 2400), 16 },
+	PageSet{ "large", ivec2(3200, 4800), 4 }
+};
+constexpr array<const char*, 3> pictureTypes = { "jpg", "png", "bmp" };	// SDL_image can't encode WebP
+constexpr array<ArchiveType, 3> archiveTypes = {
+	ArchiveType{ "cbz", archive_write_set_format_zip },
+	ArchiveType{ "tar", archive_write_set_format_ustar },
+	ArchiveType{ "7z", archive_write_set_format_7zip }
+};
+constexpr uint listFileCount = 5000;
+constexpr uint sortNameCount = 100'000;
+constexpr uint limitSizeTarget = 2048;
+
+// accesses the limit used by every renderer when creating textures
+struct SizeLimiter : Renderer {
+	using Renderer::limitSize;
+};
+
+// gradients with some noise so the encoders have something to work with
+SDL_Surface* makePage(ivec2 res, uint seed) {
+	SDL_Surface* img = SDL_CreateRGBSurfaceWithFormat(0, res.x, res.y, 24, SDL_PIXELFORMAT_RGB24);
+	if (!img)
+		throw std::runtime_error(SDL_GetError());
+
+	std::minstd_rand rng(seed);
+	for (int y = 0; y < res.y; ++y) {
+		uint8* row = static_cast<uint8*>(img->pixels) + y * img->pitch;
+		for (int x = 0; x < res.x; ++x) {
+			uint8 noise = uint8(rng() & 0x1F);
+			row[x * 3] = uint8(x * 255 / res.x) ^ noise;
+			row[x * 3 + 1] = uint8(y * 255 / res.y) ^ noise;
+			row[x * 3 + 2] = uint8((x + y + seed * 32) & 0xFF);
+		}
+	}
+	return img;
+}
+
+bool savePage(SDL_Surface* img, const fs::path& file, string_view type) {
+	string path = file.u8string();
+	if (type == "jpg")
+		return !IMG_SaveJPG(img, path.c_str(), 85);
+	if (type == "png")
+		return !IMG_SavePNG(img, path.c_str());
+	return !SDL_SaveBMP(img, path.c_str());
+}
+
+string pageName(uint id, string_view type) {
+	return "page " + toStr(id + 1) + '.' + string(type);
+}
+
+void writeArchive(const fs::path& file, const ArchiveType& type, const fs::path& drc, const vector<fs::path>& files) {
+	archive* arch = archive_write_new();
+	type.setFormat(arch);
+#ifdef _WIN32
+	if (archive_write_open_filename_w(arch, file.c_str())) {
+#else
+	if (archive_write_open_filename(arch, file.c_str())) {
+#endif
+		string err = archive_error_string(arch);
+		archive_write_free(arch);
+		throw std::runtime_error("Failed to create " + file.u8string() + ": " + err);
+	}
+
+	for (const fs::path& it : files) {
+		std::ifstream ifs(drc / it, std::ios::binary);
+		string data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+		archive_entry* entry = archive_entry_new();
+		archive_entry_set_pathname_utf8(entry, it.u8string().c_str());
+		archive_entry_set_filetype(entry, AE_IFREG);
+		archive_entry_set_perm(entry, 0644);
+		archive_entry_set_size(entry, la_int64_t(data.size()));
+		archive_write_header(arch, entry);
+		archive_write_data(arch, data.data(), data.size());
+		archive_entry_free(entry);
+	}
+	archive_write_close(arch);
+	archive_write_free(arch);
+}
+
+// directories of pictures for every size and type, archives of the JPEG directories and a large directory of empty files
+void makeCorpus(const fs::path& corpus) {
+	for (const PageSet& set : pageSets)
+		for (const char* type : pictureTypes)
+			if (fs::path drc = corpus / (string(set.name) + '_' + type); !fs::exists(drc)) {
+				logInfo("Generating ", drc);
+				fs::create_directories(drc);
+				for (uint i = 0; i < set.pages; ++i) {
+					SDL_Surface* img = makePage(set.res, i);
+					bool ok = savePage(img, drc / fs::u8path(pageName(i, type)), type);
+					SDL_FreeSurface(img);
+					if (!ok)
+						throw std::runtime_error("Failed to save page: "s + SDL_GetError());
+				}
+			}
+
+	for (const PageSet& set : pageSets) {
+		fs::path drc = corpus / (set.name + "_jpg"s);
+		vector<fs::path> files = FileSys::listDir(drc, true, false);
+		for (const ArchiveType& type : archiveTypes)
+			if (fs::path file = corpus / (string(set.name) + '.' + type.ext); !fs::exists(file)) {
+				logInfo("Generating ", file);
+				writeArchive(file, type, drc, files);
+			}
+	}
+
+	if (fs::path drc = corpus / "list"; !fs::exists(drc)) {
+		logInfo("Generating ", drc);
+		fs::create_directories(drc);
+		for (uint i = 0; i < listFileCount; ++i)
+			std::ofstream(drc / fs::u8path(pageName(i, pictureTypes[i % pictureTypes.size()])));
+	}
+}
+
+// loaders report to the event queue, which needs to be emptied after every run
+uint drainLoaderEvents() {
+	uint pics = 0;
+	for (SDL_Event event; SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_USEREVENT_READER_PROGRESS, SDL_USEREVENT_READER_FINISHED) > 0;) {
+		if (event.user.type == SDL_USEREVENT_READER_PROGRESS)
+			delete[] static_cast<char*>(event.user.data1);
+		else {
+			PictureLoader* pl = static_cast<PictureLoader*>(event.user.data1);
+			pics += uint(pl->pics.size());
+			delete pl;
+		}
+	}
+	return pics;
+}
+
+}
+
+void benchLoaders(Bench& bench, const fs::path& corpus) {
+	makeCorpus(corpus);
+
+	fs::path listDrc = corpus / "list";
+	bench.run("listDir", 20, [&listDrc]() -> Bench::Work {
+		return Bench::Work{ FileSys::listDir(listDrc, true, false, false).size(), 0 };
+	});
+
+	vector<string> names(sortNameCount);
+	for (uint i = 0; i < sortNameCount; ++i)
+		names[i] = "chapter " + toStr(i / 100 + 1) + "/page " + toStr(i % 100 + 1) + ".jpg";
+	std::shuffle(names.begin(), names.end(), std::minstd_rand(sortNameCount));
+	bench.run("sortStrNatCmp", 10, [&names]() -> Bench::Work {
+		vector<string> sorted = names;
+		std::sort(sorted.begin(), sorted.end(), StrNatCmp());
+		return Bench::Work{ sorted.size(), 0 };
+	});
+
+	for (const PageSet& set : pageSets)
+		for (const ArchiveType& type : archiveTypes) {
+			fs::path file = corpus / (string(set.name) + '.' + type.ext);
+			string suffix = '_' + string(set.name) + '_' + type.ext;
+			uint64 size = Bench::fileSize(file);
+			bench.run("listArchivePictures" + suffix, 3, [&file, size]() -> Bench::Work {
+				vector<string> pnames;
+				return Bench::Work{ FileSys::listArchivePictures(file, pnames).size(), size };
+			});
+			bench.run("loadArchivePicture" + suffix, 3, [&file, size]() -> Bench::Work {
+				Bench::Work work{ 0, size };
+				if (archive* arch = FileSys::openArchive(file)) {
+					for (archive_entry* entry; !archive_read_next_header(arch, &entry);)
+						if (SDL_Surface* img = FileSys::loadArchivePicture(arch, entry)) {
+							SDL_FreeSurface(img);
+							++work.items;
+						}
+					archive_read_free(arch);
+				}
+				return work;
+			});
+			bench.run("loadTexturesArchive" + suffix, 3, [&file, size]() -> Bench::Work {
+				std::atomic_bool running = true;
+				DrawSys::loadTexturesArchiveThreaded(running, std::make_unique<PictureLoader>(file, string(), PicLim(PicLim::Type::none), true, false));
+				return Bench::Work{ drainLoaderEvents(), size };
+			});
+		}
+
+	for (const PageSet& set : pageSets)
+		for (const char* type : pictureTypes) {
+			fs::path drc = corpus / (string(set.name) + '_' + type);
+			uint64 size = Bench::dirSize(drc);
+			bench.run("loadTexturesDirectory_"s + set.name + '_' + type, 3, [&drc, size]() -> Bench::Work {
+				std::atomic_bool running = true;
+				DrawSys::loadTexturesDirectoryThreaded(running, std::make_unique<PictureLoader>(drc, string(), PicLim(PicLim::Type::none), true, false));
+				return Bench::Work{ drainLoaderEvents(), size };
+			});
+		}
+
+	constexpr uint limitIterations = 10;
+	SDL_Surface* big = makePage(pageSets.back().res, 0);
+	vector<SDL_Surface*> copies(limitIterations);
+	for (SDL_Surface*& it : copies)
+		it = SDL_ConvertSurface(big, big->format, 0);
+	SDL_FreeSurface(big);
+	uint next = 0;
+	bench.run("limitSize", limitIterations, [&copies, &next]() -> Bench::Work {
+		SDL_Surface* img = copies[next++];
+		Bench::Work work{ 1, uint64(img->pitch) * uint64(img->h) };
+		SDL_FreeSurface(SizeLimiter::limitSize(img, limitSizeTarget));
+		return work;
+	});
+	for (; next < copies.size(); ++next)
+		SDL_FreeSurface(copies[next]);
+}
@@ -0,0 +1,262 @@
+#include "bench.h"
+#include "engine/rendererGl.h"
+#include "engine/rendererVk.h"
+
+#if defined(WITH_OPENGL) || defined(WITH_VULKAN)
+namespace {
+
+struct Backend {
+	const char* name;
+	const char* driver;	// SDL video driver to try first
+	uint32 flags;
+	Renderer* (*create)(const umap<int, SDL_Window*>& windows, Settings* sets, const fs::path& dirSets, ivec2& viewRes);
+};
+
+struct PixelFormat {
+	const char* name;
+	uint32 format;
+};
+
+constexpr ivec2 viewSize(1280, 720);
+constexpr vec4 clearColor(0.f, 0.f, 0.f, 1.f);
+constexpr uint frameIterations = 50;
+constexpr uint rectCount = 10'000;
+constexpr uint selectIterations = 200;
+constexpr uint selectRectCount = 1'000;
+constexpr uint uploadIterations = 10;
+constexpr array<int, 3> uploadSizes = { 256, 1024, 4096 };
+constexpr array<PixelFormat, 3> uploadFormats = {
+	PixelFormat{ "rgba", SDL_PIXELFORMAT_RGBA32 },
+	PixelFormat{ "bgra", SDL_PIXELFORMAT_BGRA32 },
+	PixelFormat{ "rgb", SDL_PIXELFORMAT_RGB24 }
+};
+constexpr uint lifeIterations = 5;
+constexpr uint lifeTextureCount = 64;
+constexpr int lifeTextureSize = 512;
+
+vector<Backend> backends() {
+	return {
+#ifdef WITH_OPENGL
+		Backend{ "gl", "offscreen", SDL_WINDOW_OPENGL, [](const umap<int, SDL_Window*>& windows, Settings* sets, const fs::path&, ivec2& viewRes) -> Renderer* {
+			return new RendererGl(windows, sets, viewRes, ivec2(0), clearColor);
+		} },
+#endif
+#ifdef WITH_VULKAN
+		// SDL's offscreen driver can't create Vulkan surfaces, so this needs a display like Xvfb
+		Backend{ "vk", nullptr, SDL_WINDOW_VULKAN, [](const umap<int, SDL_Window*>& windows, Settings* sets, const fs::path& dirSets, ivec2& viewRes) -> Renderer* {
+			return new RendererVk(windows, sets, dirSets, viewRes, ivec2(0), clearColor);
+		} }
+#endif
+	};
+}
+
+SDL_Surface* makeImage(ivec2 res, uint32 format) {
+	SDL_Surface* img = SDL_CreateRGBSurfaceWithFormat(0, res.x, res.y, SDL_BITSPERPIXEL(format), format);
+	if (!img)
+		throw std::runtime_error(SDL_GetError());
+	for (int y = 0; y < res.y; ++y) {
+		uint8* row = static_cast<uint8*>(img->pixels) + y * img->pitch;
+		for (int x = 0; x < res.x * img->format->BytesPerPixel; ++x)
+			row[x] = uint8(x ^ y);
+	}
+	return img;
+}
+
+Texture* makeTexture(Renderer* renderer, ivec2 res, uint32 format) {
+	Texture* tex = renderer->texFromImg(makeImage(res, format), Texture::Owner::reader);
+	if (!tex)
+		throw std::runtime_error("Failed to create texture");
+	return tex;
+}
+
+// let the renderer retire its asynchronous uploads, which is when a texture can be drawn without stalling
+void flushUploads(Renderer* renderer, Renderer::View* view) {
+	while (renderer->hasPendingUploads()) {
+		renderer->startDraw(view);
+		renderer->finishDraw(view);
+		renderer->finishRender();
+	}
+}
+
+// non overlapping rectangles over the whole view
+Recti gridRect(uint id, uint count, const Recti& area) {
+	int cols = int(std::ceil(std::sqrt(float(count) * float(area.w) / float(area.h))));
+	ivec2 cell = glm::max(ivec2(area.w / cols, area.h / int((count + uint(cols) - 1) / uint(cols))), ivec2(1));
+	return Recti(area.pos() + ivec2(int(id) % cols, int(id) / cols) * cell, cell);
+}
+
+void benchDraw(Bench& bench, Renderer* renderer, const string& suffix) {
+	Renderer::View* view = renderer->getViews().begin()->second;
+	Texture* blank = makeTexture(renderer, ivec2(2), SDL_PIXELFORMAT_RGBA32);
+	vector<Recti> rects(rectCount);
+	for (uint i = 0; i < rectCount; ++i)
+		rects[i] = gridRect(i, rectCount, view->rect);
+
+	bench.run("drawRect" + suffix, frameIterations, [renderer, view, blank, &rects]() -> Bench::Work {
+		renderer->startDraw(view);
+		for (uint i = 0; i < rects.size(); ++i)
+			renderer->drawRect(blank, rects[i], view->rect, vec4(float(i % 7) / 6.f, float(i % 5) / 4.f, float(i % 3) / 2.f, 1.f));
+		renderer->finishDraw(view);
+		renderer->finishRender();
+		return Bench::Work{ rects.size(), 0 };
+	});
+	renderer->freeTexture(blank);
+}
+
+void benchSelect(Bench& bench, Renderer* renderer, const string& suffix) {
+	Renderer::View* view = renderer->getViews().begin()->second;
+	vector<uint64> ids(selectRectCount);	// the renderers only pass the widget addresses through
+	vector<Recti> rects(selectRectCount);
+	for (uint i = 0; i < selectRectCount; ++i)
+		rects[i] = gridRect(i, selectRectCount, view->rect);
+
+	uint next = 0;
+	bench.run("select" + suffix, selectIterations, [renderer, view, &ids, &rects, &next]() -> Bench::Work {
+		uint target = next++ * 7919 % uint(rects.size());
+		renderer->startSelDraw(view, rects[target].pos() + rects[target].size() / 2);
+		for (uint i = 0; i < rects.size(); ++i)
+			renderer->drawSelRect(reinterpret_cast<const Widget*>(&ids[i]), rects[i], view->rect);
+		if (renderer->finishSelDraw(view) != reinterpret_cast<const Widget*>(&ids[target]))
+			throw std::runtime_error("Selection returned the wrong widget");
+		return Bench::Work{ rects.size(), 0 };
+	});
+}
+
+void benchUpload(Bench& bench, Renderer* renderer, const string& suffix) {
+	Renderer::View* view = renderer->getViews().begin()->second;
+	for (int size : uploadSizes)
+		for (const PixelFormat& pf : uploadFormats) {
+			string name = "texFromImg" + suffix + '_' + toStr(size) + '_' + pf.name;
+			if (!bench.wants(name))
+				continue;
+
+			SDL_Surface* img = makeImage(ivec2(size), pf.format);
+			vector<double> samples;
+			Bench::Work work;
+			for (uint i = 0; i < uploadIterations; ++i) {
+				SDL_Surface* copy = SDL_ConvertSurface(img, img->format, 0);
+				uint64 bytes = uint64(copy->pitch) * uint64(copy->h);
+				uint64 start = SDL_GetPerformanceCounter();
+				Texture* tex = renderer->texFromImg(copy, Texture::Owner::reader);
+				flushUploads(renderer, view);
+				samples.push_back(Bench::elapsedMs(start));
+				if (tex) {
+					renderer->freeTexture(tex);
+					++work.items;
+					work.bytes += bytes;
+				}
+			}
+			SDL_FreeSurface(img);
+			bench.add(std::move(name), std::move(samples), work);
+		}
+}
+
+// creation and teardown of a renderer that holds a library's worth of textures
+void benchLifetime(Bench& bench, const Backend& backend, const umap<int, SDL_Window*>& windows, Settings* sets, const fs::path& dirSets, const string& suffix) {
+	string createName = "rendererCreate" + suffix, destroyName = "rendererDestroy" + suffix;
+	if (!bench.wants(createName) && !bench.wants(destroyName))
+		return;
+
+	vector<double> createSamples, destroySamples;
+	for (uint i = 0; i < lifeIterations; ++i) {
+		ivec2 viewRes;
+		uint64 start = SDL_GetPerformanceCounter();
+		Renderer* renderer = backend.create(windows, sets, dirSets, viewRes);
+		createSamples.push_back(Bench::elapsedMs(start));
+
+		vector<Texture*> texes(lifeTextureCount);
+		for (Texture*& it : texes)
+			it = makeTexture(renderer, ivec2(lifeTextureSize), SDL_PIXELFORMAT_RGBA32);
+		flushUploads(renderer, renderer->getViews().begin()->second);
+
+		start = SDL_GetPerformanceCounter();
+		for (Texture* it : texes)
+			renderer->freeTexture(it);
+		delete renderer;
+		destroySamples.push_back(Bench::elapsedMs(start));
+	}
+	if (bench.wants(createName))
+		bench.add(std::move(createName), std::move(createSamples), Bench::Work{ lifeIterations, 0 });
+	if (bench.wants(destroyName))
+		bench.add(std::move(destroyName), std::move(destroySamples), Bench::Work{ uint64(lifeIterations) * lifeTextureCount, uint64(lifeIterations) * lifeTextureCount * lifeTextureSize * lifeTextureSize * 4 });
+}
+
+// pick lavapipe over any hardware devices, there's nothing to choose from for OpenGL
+bool pickSoftwareDevice(const Backend& backend, const umap<int, SDL_Window*>& windows, Settings* sets, const fs::path& dirSets) {
+	ivec2 viewRes;
+	uptr<Renderer> renderer(backend.create(windows, sets, dirSets, viewRes));
+	bool compression;
+	vector<pair<u32vec2, string>> devices;
+	renderer->getAdditionalSettings(compression, devices);
+	if (devices.empty())
+		return true;
+
+	vector<pair<u32vec2, string>>::iterator it = std::find_if(devices.begin(), devices.end(), [](const pair<u32vec2, string>& dev) -> bool { return dev.second.find("llvmpipe") != string::npos; });
+	if (it == devices.end())
+		return false;
+	sets->device = it->first;
+	return true;
+}
+
+void benchBackend(Bench& bench, const Backend& backend, const fs::path& corpus, bool software) {
+	if (backend.driver)
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, backend.driver);
+	if (SDL_InitSubSystem(SDL_INIT_VIDEO)) {
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, nullptr);
+		if (SDL_InitSubSystem(SDL_INIT_VIDEO)) {
+			logError("Skipping ", backend.name, ": ", SDL_GetError());
+			return;
+		}
+	}
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+#ifdef OPENGLES
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+#else
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+#endif
+
+	umap<int, SDL_Window*> windows;
+	if (SDL_Window* win = SDL_CreateWindow("VertiRead", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, viewSize.x, viewSize.y, backend.flags))
+		windows.emplace(Renderer::singleDspId, win);
+	else
+		logError("Skipping ", backend.name, ": ", SDL_GetError());
+
+	Settings sets(corpus, vector<string>());
+	sets.vsync = false;
+	sets.compression = false;	// measure the transfer rather than the driver's encoder
+	string suffix = '_' + string(backend.name);
+	try {
+		if (!windows.empty() && software && !pickSoftwareDevice(backend, windows, &sets, corpus))
+			logError("Skipping ", backend.name, ": no llvmpipe device");
+		else if (!windows.empty()) {
+			ivec2 viewRes;
+			uptr<Renderer> renderer(backend.create(windows, &sets, corpus, viewRes));
+			benchDraw(bench, renderer.get(), suffix);
+			benchSelect(bench, renderer.get(), suffix);
+			benchUpload(bench, renderer.get(), suffix);
+			renderer.reset();
+			benchLifetime(bench, backend, windows, &sets, corpus, suffix);
+		}
+	} catch (const std::runtime_error& e) {
+		logError("Skipping the rest of ", backend.name, ": ", e.what());
+	}
+
+	for (auto [id, win] : windows)
+		SDL_DestroyWindow(win);
+	SDL_QuitSubSystem(SDL_INIT_VIDEO);
+	SDL_SetHint(SDL_HINT_VIDEODRIVER, nullptr);
+}
+
+}
+#endif
+
+void benchRenderers([[maybe_unused]] Bench& bench, [[maybe_unused]] const fs::path& corpus, [[maybe_unused]] bool software) {
+#if defined(WITH_OPENGL) || defined(WITH_VULKAN)
+	// Mesa reads this when a context gets created and falls back to llvmpipe
+	if (software)
+		SDL_setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+	for (const Backend& it : backends())
+		benchBackend(bench, it, corpus, software);
+#endif
+}
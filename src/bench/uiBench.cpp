@@ -0,0 +1,184 @@
+#include "bench.h"
+#include "engine/drawSys.h"
+#include "engine/scene.h"
+#include "engine/world.h"
+#include "prog/progs.h"
+#include <random>
+#ifdef _WIN32
+#include <SDL_image.h>
+#else
+#include <SDL2/SDL_image.h>
+#endif
+
+namespace {
+
+constexpr array<uint, 3> itemCounts = { 1'000, 10'000, 100'000 };
+constexpr ivec2 pageRes(60, 90);
+constexpr uint scrollIterations = 500;
+constexpr uint queryIterations = 1000;
+constexpr uint resetIterations = 5;
+constexpr float zoomFactor = 1.2f;
+
+// one small page copied over and over, so every directory works for both the browser and the reader
+void makeUiCorpus(const fs::path& corpus) {
+	fs::path page = corpus / "ui_page.png";
+	if (!fs::exists(page)) {
+		fs::create_directories(corpus);
+		SDL_Surface* img = SDL_CreateRGBSurfaceWithFormat(0, pageRes.x, pageRes.y, 24, SDL_PIXELFORMAT_RGB24);
+		if (!img)
+			throw std::runtime_error(SDL_GetError());
+		SDL_FillRect(img, nullptr, SDL_MapRGB(img->format, 200, 180, 160));
+		bool ok = !IMG_SavePNG(img, page.u8string().c_str());
+		SDL_FreeSurface(img);
+		if (!ok)
+			throw std::runtime_error("Failed to save page: "s + SDL_GetError());
+	}
+
+	for (uint cnt : itemCounts)
+		if (fs::path drc = corpus / ("ui_" + toStr(cnt)); !fs::exists(drc)) {
+			logInfo("Generating ", drc);
+			fs::create_directories(drc);
+			for (uint i = 0; i < cnt; ++i)
+				fs::copy_file(page, drc / fs::u8path("page " + toStr(i + 1) + ".png"));
+		}
+}
+
+void drawFrame() {
+	World::drawSys()->invalidate();
+	World::drawSys()->drawWidgets(World::scene(), false, nullptr);
+}
+
+// loads the reader the same way the main loop does, but without waiting for input
+void openReader(const fs::path& drc) {
+	if (!World::program()->openFile(drc / "page 1.png"))
+		throw std::runtime_error("Failed to open " + drc.u8string());
+
+	for (SDL_Event event; SDL_WaitEvent(&event);) {
+		if (event.type == SDL_USEREVENT_READER_PROGRESS)
+			World::program()->eventReaderProgress(event.user);
+		else if (event.type == SDL_USEREVENT_READER_FINISHED) {
+			World::program()->eventReaderFinished(event.user);
+			return;
+		}
+	}
+	throw std::runtime_error("Failed to wait for the reader: "s + SDL_GetError());
+}
+
+// wheel scrolling by a fraction of the view that starts over once the end is reached
+void benchScroll(Bench& bench, const string& name, ScrollArea* area) {
+	int step = std::max(area->size()[area->isVertical()] / 4, 1);
+	area->scrollToLimit(true);
+	bench.run(name, scrollIterations, [area, step]() -> Bench::Work {
+		if (area->visibleWidgets().y < area->getWidgets().size())
+			area->onScroll(ivec2(0, step));
+		else
+			area->scrollToLimit(true);
+		drawFrame();
+		return Bench::Work{ 1, 0 };
+	});
+
+	// random jumps are the worst case for the virtual list, since nothing near the view is cached
+	std::minstd_rand rng(scrollIterations);
+	bench.run(name + "Jump", scrollIterations, [area, &rng]() -> Bench::Work {
+		area->scrollToLimit(true);
+		area->moveListPos(vswap(0, int(rng() % uint(INT_MAX)), !area->isVertical()));
+		drawFrame();
+		return Bench::Work{ 1, 0 };
+	});
+}
+
+// bisects the item offsets from random list positions
+void benchVisibleWidgets(Bench& bench, const string& name, ScrollArea* area) {
+	std::minstd_rand rng(queryIterations);
+	bench.run(name, queryIterations, [area, &rng]() -> Bench::Work {
+		area->scrollToLimit(true);
+		area->moveListPos(ivec2(int(rng() % uint(INT_MAX))));
+		mvec2 vis = area->visibleWidgets();
+		return Bench::Work{ vis.y - vis.x, 0 };
+	});
+}
+
+// finds the widget under random cursor positions within the current view
+void benchGetSelected(Bench& bench, const string& name) {
+	std::minstd_rand rng(queryIterations);
+	ivec2 res = glm::max(World::drawSys()->getViewRes(), ivec2(1));
+	bench.run(name, queryIterations, [&rng, res]() -> Bench::Work {
+		World::scene()->updateSelect(ivec2(int(rng() % uint(res.x)), int(rng() % uint(res.y))));
+		return Bench::Work{ 1, 0 };
+	});
+}
+
+void benchBrowser(Bench& bench, const fs::path& drc, const string& suffix) {
+	if (!World::program()->openFile(drc))
+		throw std::runtime_error("Failed to open " + drc.u8string());
+	bench.run("uiBrowserResetLayouts" + suffix, resetIterations, []() -> Bench::Work {
+		World::scene()->resetLayouts();
+		return Bench::Work{ 1, 0 };
+	});
+
+	ScrollArea* list = static_cast<ProgPageBrowser*>(World::state())->fileList;
+	drawFrame();
+	benchScroll(bench, "uiBrowserScroll" + suffix, list);
+	benchVisibleWidgets(bench, "uiBrowserVisibleWidgets" + suffix, list);
+	benchGetSelected(bench, "uiBrowserGetSelected" + suffix);
+}
+
+void benchReader(Bench& bench, const fs::path& drc, const string& suffix) {
+	openReader(drc);
+	ReaderBox* reader = static_cast<ProgReader*>(World::state())->reader;
+	drawFrame();
+	benchScroll(bench, "uiReaderScroll" + suffix, reader);
+
+	// zoom in and out around the middle of the list so the position keeps getting rescaled
+	reader->scrollToWidgetPos(reader->getWidgets().size() / 2);
+	uint zooms = 0;
+	bench.run("uiReaderZoom" + suffix, scrollIterations, [reader, &zooms]() -> Bench::Work {
+		reader->setZoom(zooms++ % 4 < 2 ? zoomFactor : 1.f / zoomFactor);
+		drawFrame();
+		return Bench::Work{ 1, 0 };
+	});
+
+	benchVisibleWidgets(bench, "uiReaderVisibleWidgets" + suffix, reader);
+	benchGetSelected(bench, "uiReaderGetSelected" + suffix);
+}
+
+// a selection must not outlive the list it was made in, since setting the library directory reads the selected label
+void checkDirChangeDeselects(const fs::path& corpus) {
+	World::program()->eventOpenLibDirBrowser();
+	ScrollArea* list = static_cast<ProgSearchDir*>(World::state())->list;
+	if (World::browser()->goTo(corpus) != fs::file_type::directory)
+		throw std::runtime_error("Failed to open " + corpus.u8string());
+	World::state()->eventDirChange();
+	if (list->getWidgets().empty())
+		throw std::runtime_error("No directories in " + corpus.u8string());
+
+	list->selectWidget(0);
+	World::state()->eventDirChange();
+	if (!list->getSelected().empty())
+		throw std::runtime_error("Selection kept after changing directory");
+	World::program()->eventExitBrowser();
+}
+
+}
+
+void benchUi(Bench& bench, const fs::path& corpus) {
+	makeUiCorpus(corpus);
+
+	const char* argv[] = { "vertiread_bench", "--headless" };
+	World::setArgs(int(std::size(argv)), argv, stos);
+	int rc = World::winSys()->start([&bench, &corpus]() {
+		// keep the results independent of background threads and the user's limits
+		World::sets()->preview = false;
+		World::sets()->picLim = PicLim(PicLim::Type::none);
+		World::sets()->gpuSelecting = false;
+		checkDirChangeDeselects(corpus);
+		for (uint cnt : itemCounts) {
+			fs::path drc = corpus / ("ui_" + toStr(cnt));
+			string suffix = '_' + toStr(cnt);
+			benchBrowser(bench, drc, suffix);
+			benchReader(bench, drc, suffix);
+		}
+	});
+	if (rc != EXIT_SUCCESS)
+		throw std::runtime_error("UI benchmark failed");
+}
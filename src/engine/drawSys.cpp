@@ -1,10 +1,14 @@
 #include "rendererDx.h"
 #include "rendererGl.h"
+#include "rendererNull.h"
+#include "rendererSw.h"
 #include "rendererVk.h"
 #include "drawSys.h"
 #include "fileSys.h"
 #include "scene.h"
+#include "windowSys.h"
 #include "utils/layouts.h"
+#include "utils/trace.h"
 #ifdef _WIN32
 #include <SDL_image.h>
 #else
@@ -65,27 +69,178 @@ TTF_Font* FontSet::getFont(int height) {
 	return font;
 }
 
-int FontSet::length(const char* text, int height) {
+int FontSet::length(string_view text, int height) {
+	Atlas& atlas = getAtlas(height);
 	int len = 0;
-	TTF_SizeUTF8(getFont(height), text, &len, nullptr);
+	for (sizet i = 0; i < text.length();) {
+		char32_t ch = nextChar(text, i);
+		len += getGlyph(atlas, ch, height).advance;
+		if (i < text.length()) {
+			sizet j = i;
+			len += getKerning(atlas, ch, nextChar(text, j), height);
+		}
+	}
 	return len;
 }
 
-int FontSet::length(char* text, sizet length, int height) {
-	int len = 0;
-	char tmp = text[length];
-	text[length] = '\0';
-	TTF_SizeUTF8(getFont(height), text, &len, nullptr);
-	text[length] = tmp;
-	return len;
+TextLine FontSet::layout(string_view text, int height) {
+	Atlas& atlas = getAtlas(height);
+	TextLine line;
+	line.height = height;
+	line.glyphs.reserve(text.length());
+	for (sizet i = 0; i < text.length();) {
+		char32_t ch = nextChar(text, i);
+		if (!line.glyphs.empty())
+			line.width += getKerning(atlas, line.glyphs.back().first, ch, height);
+
+		Glyph& glyph = getGlyph(atlas, ch, height);
+		if (glyph.page == UINT_MAX)
+			rasterize(atlas, glyph, ch, height);
+		line.glyphs.emplace_back(ch, line.width);
+		line.width += glyph.advance;
+	}
+	return line;
+}
+
+void FontSet::uploadAtlases(Renderer* renderer) {
+	for (auto& [height, atlas] : atlases)
+		for (AtlasPage& it : atlas.pages)
+			if (!it.dirty.empty()) {
+				// only new glyphs get copied unless the page grew
+				if (it.tex && it.tex->getRes() == ivec2(it.img->w, it.img->h))
+					renderer->updateText(it.tex, it.img, it.dirty);
+				else {
+					if (it.tex)
+						renderer->freeTexture(it.tex);
+					it.tex = renderer->texFromText(SDL_DuplicateSurface(it.img));
+				}
+				it.dirty = Recti(0);
+			}
+}
+
+void FontSet::freeAtlases(Renderer* renderer) {
+	for (auto& [height, atlas] : atlases)
+		for (AtlasPage& it : atlas.pages) {
+			if (it.tex)
+				renderer->freeTexture(it.tex);
+			SDL_FreeSurface(it.img);
+		}
+	atlases.clear();
+}
+
+FontSet::Atlas& FontSet::getAtlas(int height) {
+	if (umap<int, Atlas>::iterator it = atlases.find(height); it != atlases.end())
+		return it->second;
+
+	Atlas& atlas = atlases[height];
+	if (TTF_Font* fnt = getFont(height))
+		atlas.lineHeight = TTF_FontHeight(fnt);
+	return atlas;
+}
+
+FontSet::Glyph& FontSet::getGlyph(Atlas& atlas, char32_t ch, int height) {
+	if (umap<char32_t, Glyph>::iterator it = atlas.glyphs.find(ch); it != atlas.glyphs.end())
+		return it->second;
+
+	Glyph& glyph = atlas.glyphs[ch];
+	if (TTF_Font* fnt = getFont(height)) {
+		int minx, maxx, miny, maxy;
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+		if (!TTF_GlyphMetrics32(fnt, ch, &minx, &maxx, &miny, &maxy, &glyph.advance))
+#else
+		if (!TTF_GlyphMetrics(fnt, ch <= 0xFFFF ? Uint16(ch) : Uint16('?'), &minx, &maxx, &miny, &maxy, &glyph.advance))
+#endif
+			glyph.ofs = std::min(minx, 0);
+	}
+	return glyph;
+}
+
+int FontSet::getKerning(Atlas& atlas, char32_t prev, char32_t ch, int height) {
+	uint64 key = (uint64(prev) << 32) | ch;
+	if (umap<uint64, int>::iterator it = atlas.kerning.find(key); it != atlas.kerning.end())
+		return it->second;
+
+	int kern = 0;
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+	if (TTF_Font* fnt = getFont(height))
+		kern = TTF_GetFontKerningSizeGlyphs32(fnt, prev, ch);
+#elif SDL_TTF_VERSION_ATLEAST(2, 0, 14)
+	if (TTF_Font* fnt = getFont(height); fnt && prev <= 0xFFFF && ch <= 0xFFFF)
+		kern = TTF_GetFontKerningSizeGlyphs(fnt, Uint16(prev), Uint16(ch));
+#endif
+	return atlas.kerning.emplace(key, kern).first->second;
+}
+
+void FontSet::rasterize(Atlas& atlas, Glyph& glyph, char32_t ch, int height) {
+	glyph.page = 0;	// the rect stays empty if there's nothing to draw
+	TTF_Font* fnt = getFont(height);
+	if (!fnt)
+		return;
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
+	SDL_Surface* img = TTF_RenderGlyph32_Blended(fnt, ch, { 255, 255, 255, 255 });
+#else
+	SDL_Surface* img = TTF_RenderGlyph_Blended(fnt, ch <= 0xFFFF ? Uint16(ch) : Uint16('?'), { 255, 255, 255, 255 });
+#endif
+	if (!img)
+		return;
+	if (img->w > atlasPageSize || img->h > atlasPageSize) {
+		SDL_FreeSurface(img);
+		return;
+	}
+
+	// find a spot in a row of the last page, grow it or add a new page if there's no room left
+	AtlasPage* page = !atlas.pages.empty() ? &atlas.pages.back() : nullptr;
+	if (page && page->cursor.x + img->w > atlasPageSize)
+		page->cursor = ivec2(0, page->cursor.y + atlas.lineHeight + 1);
+	if (page && page->cursor.y + img->h > page->img->h) {
+		if (int ph = std::min(page->img->h * 2, atlasPageSize); page->cursor.y + img->h <= ph) {
+			if (SDL_Surface* big = SDL_CreateRGBSurfaceWithFormat(0, atlasPageSize, ph, 32, SDL_PIXELFORMAT_ARGB8888)) {
+				SDL_SetSurfaceBlendMode(page->img, SDL_BLENDMODE_NONE);
+				SDL_BlitSurface(page->img, nullptr, big, nullptr);
+				SDL_FreeSurface(page->img);
+				page->img = big;
+			} else
+				page = nullptr;
+		} else
+			page = nullptr;
+	}
+	if (!page) {
+		SDL_Surface* pimg = SDL_CreateRGBSurfaceWithFormat(0, atlasPageSize, std::min(std::max(atlas.lineHeight, img->h) * 4, atlasPageSize), 32, SDL_PIXELFORMAT_ARGB8888);
+		if (!pimg) {
+			logError("failed to create glyph atlas page: ", SDL_GetError());
+			SDL_FreeSurface(img);
+			return;
+		}
+		page = &atlas.pages.emplace_back(pimg);
+	}
+
+	SDL_Rect dst = { page->cursor.x, page->cursor.y, img->w, img->h };
+	SDL_SetSurfaceBlendMode(img, SDL_BLENDMODE_NONE);
+	SDL_BlitSurface(img, nullptr, page->img, &dst);
+	glyph.rect = Recti(page->cursor, img->w, img->h);
+	glyph.page = uint(page - atlas.pages.data());
+	page->cursor.x += img->w + 1;
+	page->dirty = page->dirty.unite(glyph.rect);
+	SDL_FreeSurface(img);
+}
+
+char32_t FontSet::nextChar(string_view text, sizet& i) {
+	char32_t ch = uchar(text[i++]);
+	int len = ch >= 0xF0 ? 3 : ch >= 0xE0 ? 2 : ch >= 0xC0 ? 1 : 0;
+	if (len)
+		ch &= 0x7F >> (len + 1);
+	for (; len && i < text.length() && (text[i] & 0xC0) == 0x80; --len)
+		ch = (ch << 6) | (uchar(text[i++]) & 0x3F);
+	return ch;
 }
 
 // PICTURE LOADER
 
-PictureLoader::PictureLoader(fs::path cdrc, string pfirst, const PicLim& plim, bool forward, bool hidden) :
+PictureLoader::PictureLoader(fs::path cdrc, string pfirst, const PicLim& plim, bool forward, bool hidden, float bytesPerPixel) :
 	curDir(std::move(cdrc)),
 	firstPic(std::move(pfirst)),
 	picLim(plim),
+	texBytesPerPixel(bytesPerPixel),
 	fwd(forward),
 	showHidden(hidden)
 {}
@@ -101,6 +256,10 @@ vector<pair<sizet, SDL_Surface*>> PictureLoader::extractPics() {
 	return out;
 }
 
+uptrt PictureLoader::textureSize(uptrt pixels) const {
+	return uptrt(double(pixels) * double(texBytesPerPixel));
+}
+
 string PictureLoader::limitToStr(uptrt c, uptrt m, sizet mag) const {
 	switch (picLim.type) {
 	case PicLim::Type::none: case PicLim::Type::count:
@@ -122,14 +281,14 @@ char* PictureLoader::progressText(string_view val, string_view lim) {
 
 // DRAW SYS
 
-DrawSys::DrawSys(const umap<int, SDL_Window*>& windows, Settings* sets, const FileSys* fileSys, int iconSize) :
+DrawSys::DrawSys(const umap<int, SDL_Window*>& windows, Settings::Renderer rnd, Settings* sets, const FileSys* fileSys, int iconSize) :
 	colors(fileSys->loadColors(sets->setTheme(sets->getTheme(), fileSys->getAvailableThemes())))
 {
 	ivec2 origin(INT_MAX);
 	for (auto [id, rct] : sets->displays)
 		origin = glm::min(origin, rct.pos());
 
-	switch (sets->renderer) {
+	switch (rnd) {
 #ifdef WITH_DIRECTX
 	case Settings::Renderer::directx:
 		renderer = new RendererDx(windows, sets, viewRes, origin, colors[uint8(Color::background)]);
@@ -142,41 +301,56 @@ DrawSys::DrawSys(const umap<int, SDL_Window*>& windows, Settings* sets, const Fi
 #endif
 #ifdef WITH_VULKAN
 	case Settings::Renderer::vulkan:
-		renderer = new RendererVk(windows, sets, viewRes, origin, colors[uint8(Color::background)]);
+		renderer = new RendererVk(windows, sets, fileSys->getDirSets(), viewRes, origin, colors[uint8(Color::background)]);
+		break;
 #endif
+	case Settings::Renderer::software:
+		renderer = new RendererSw(windows, sets, viewRes, origin, colors[uint8(Color::background)]);
+		break;
+	case Settings::Renderer::null:
+		renderer = new RendererNull(windows, sets, viewRes, origin);
 	}
 
 	SDL_Surface* white = SDL_CreateRGBSurfaceWithFormat(0, 2, 2, 32, SDL_PIXELFORMAT_RGBA32);
 	if (!white)
 		throw std::runtime_error("Failed to create blank texture: "s + SDL_GetError());
 	SDL_FillRect(white, nullptr, 0xFFFFFFFF);
-	Texture* tex = renderer->texFromImg(white);
+	Texture* tex = renderer->texFromImg(white, Texture::Owner::icon);
 	if (!tex)
 		throw std::runtime_error("Failed to create blank texture");
 	texes.emplace(string(), tex);
 	blank = tex;
 
+	if (sets->textureBudget)
+		texBudget = uptrt(sets->textureBudget) * PicLim::sizeFactors[2];
+	else if (uptrt mem = renderer->deviceMemory())
+		texBudget = uptrt(double(mem) * double(deviceMemoryShare));
+	logInfo("Texture budget ", texBudget != UINTPTR_MAX ? PicLim::memoryString(texBudget, 2) : "none"s);
+
 	for (const fs::directory_entry& it : fs::directory_iterator(fileSys->dirIcons(), fs::directory_options::skip_permission_denied)) {
 #if SDL_IMAGE_VERSION_ATLEAST(2, 6, 0)
 		if (SDL_RWops* ifh = SDL_RWFromFile(it.path().u8string().c_str(), "rb")) {
 			if (SDL_Surface* aimg = IMG_LoadSizedSVG_RW(ifh, iconSize, iconSize))
-				texes.emplace(it.path().stem().u8string(), renderer->texFromImg(aimg));
+				texes.emplace(it.path().stem().u8string(), renderer->texFromImg(aimg, Texture::Owner::icon));
 			else if (SDL_RWseek(ifh, 0, RW_SEEK_SET); SDL_Surface* bimg = IMG_Load_RW(ifh, SDL_FALSE))
-				texes.emplace(it.path().stem().u8string(), renderer->texFromImg(bimg));
+				texes.emplace(it.path().stem().u8string(), renderer->texFromImg(bimg, Texture::Owner::icon));
 			SDL_RWclose(ifh);
 		}
 #else
 		if (SDL_Surface* img = IMG_Load(it.path().u8string().c_str()))
-			texes.emplace(it.path().stem().u8string(), renderer->texFromImg(img));
+			texes.emplace(it.path().stem().u8string(), renderer->texFromImg(img, Texture::Owner::icon));
 #endif
 	}
 	setFont(sets->font, sets, fileSys);
 }
 
 DrawSys::~DrawSys() {
-	if (renderer)
+	if (renderer) {
+		logTextureMemory();
+		fonts.freeAtlases(renderer);
 		for (auto& [name, tex] : texes)
 			renderer->freeTexture(tex);
+	}
 	delete renderer;
 }
 
@@ -198,6 +372,7 @@ void DrawSys::setFont(string_view font, Settings* sets, const FileSys* fileSys)
 		sets->font = Settings::defaultFont;
 		path = fileSys->findFont(Settings::defaultFont);
 	}
+	fonts.freeAtlases(renderer);
 	fonts.init(path);
 }
 
@@ -211,45 +386,128 @@ const Texture* DrawSys::texture(const string& name) const {
 }
 
 vector<pair<string, Texture*>> DrawSys::transferPictures(PictureLoader* pl) {
+	Trace::Zone zone("transferPictures");
 	vector<pair<sizet, SDL_Surface*>> refs = pl->extractPics();
 	std::sort(refs.begin(), refs.end(), [](const pair<sizet, SDL_Surface*>& a, const pair<sizet, SDL_Surface*>& b) -> bool { return a.first < b.first; });
 
 	vector<pair<string, Texture*>> ptxv(refs.size());
-	for (sizet i = 0; i < ptxv.size(); ++i)
-		ptxv[i] = pair(std::move(pl->names[refs[i].first]), renderer->texFromImg(refs[i].second));
+	uptrt bytes = 0;
+	for (sizet i = 0; i < ptxv.size(); ++i) {
+		bytes += uptrt(refs[i].second->pitch) * uptrt(refs[i].second->h);
+		ptxv[i] = pair(std::move(pl->names[refs[i].first]), texFromImg(refs[i].second, Texture::Owner::reader));
+	}
+	zone.setBytes(bytes);
+	measureReaderTextures();
+	logTextureMemory();
 	return ptxv;
 }
 
-void DrawSys::drawWidgets(Scene* scene, bool mouseLast) {
+// the next book's size limit is based on what the textures actually ended up taking, which may only be known some time after the upload
+void DrawSys::measureReaderTextures() {
+	if (const Renderer::TexStats& st = renderer->getTexStats(Texture::Owner::reader); st.pixels && st.cpuBytes + st.gpuBytes)
+		readerBytesPerPixel = float(double(st.cpuBytes + st.gpuBytes) / double(st.pixels));
+}
+
+void DrawSys::logTextureMemory() const {
+	for (sizet i = 0; i < Texture::ownerNames.size(); ++i) {
+		const Renderer::TexStats& st = renderer->getTexStats(Texture::Owner(i));
+		logInfo("Texture memory of ", Texture::ownerNames[i], ": ", st.count, " textures, ", st.pixels, " pixels, ", PicLim::memoryString(st.gpuBytes, 2), " GPU, ", PicLim::memoryString(st.cpuBytes, 2), " CPU");
+	}
+}
+
+// the textures that went unseen the longest go first and of those the ones farthest from the view, until enough is freed to get below the budget
+vector<ResidentTexture> DrawSys::pickEvictions(vector<ResidentTexture> cands) const {
+	Renderer::TexStats tst = renderer->getTexTotals();
+	uptrt used = tst.cpuBytes + tst.gpuBytes;
+	if (used <= texBudget)
+		return {};
+
+	cands.erase(std::remove_if(cands.begin(), cands.end(), [this](const ResidentTexture& it) -> bool { return it.tex->lastUse == frame; }), cands.end());
+	std::sort(cands.begin(), cands.end(), [](const ResidentTexture& a, const ResidentTexture& b) -> bool { return a.tex->lastUse != b.tex->lastUse ? a.tex->lastUse < b.tex->lastUse : a.distance > b.distance; });
+	uptrt target = uptrt(double(texBudget) * double(evictTarget));
+	sizet cnt = 0;
+	for (; cnt < cands.size() && used > target; ++cnt)
+		used -= std::min(used, cands[cnt].tex->getCpuBytes() + cands[cnt].tex->getGpuBytes());
+	cands.resize(cnt);
+	return cands;
+}
+
+void DrawSys::invalidate(const Widget* wgt) {
+	invalidate(wgt->rect().intersect(wgt->frame()));
+}
+
+void DrawSys::invalidateTooltip(Button* but) {
+	invalidate(tooltipArea);
+	if (but && but->getTooltip())
+		invalidate(but->tooltipRect());
+}
+
+void DrawSys::drawWidgets(Scene* scene, bool mouseLast, const FrameStats* stats) {
+	// the stats overlay is refreshed along with anything else that gets drawn
+	vector<TextLine> statLines;
+	Recti statRect(0);
+	if (stats) {
+		statLines = frameStatsText(*stats);
+		statRect = frameStatsRect(statLines);
+		invalidate(statRect);
+	}
+
+	bool full = redraw || renderer->hasPendingUploads();
+	vector<Recti> areas = std::move(damage);
+	damage.clear();
+	redraw = false;
+	++frame;
+	tooltipArea = Recti(0);
+	presentTicks = 0;
+	fonts.uploadAtlases(renderer);
 	for (auto [id, view] : renderer->getViews()) {
 		try {
-			renderer->startDraw(view);
+			Recti area = view->rect;
+			if (!full) {
+				// merge the damage within this view into one region and leave the rest of the last frame
+				Recti bounds(0);
+				for (const Recti& it : areas)
+					bounds = bounds.unite(it.intersect(view->rect));
+				if (bounds.empty())
+					continue;
+				area = bounds;
+			}
+			if (area == view->rect || !renderer->startPartialDraw(view, area)) {
+				area = view->rect;
+				renderer->startDraw(view);
+			}
 
 			// draw main widgets and visible overlays
-			scene->getLayout()->drawSelf(view->rect);
+			scene->getLayout()->drawSelf(area);
 			if (scene->getOverlay() && scene->getOverlay()->on)
-				scene->getOverlay()->drawSelf(view->rect);
+				scene->getOverlay()->drawSelf(area);
 
 			// draw popup if exists and dim main widgets
 			if (scene->getPopup()) {
 				renderer->drawRect(blank, view->rect, view->rect, colorPopupDim);
-				scene->getPopup()->drawSelf(view->rect);
+				scene->getPopup()->drawSelf(area);
 			}
 
 			// draw context menu
 			if (scene->getContext())
-				scene->getContext()->drawSelf(view->rect);
+				scene->getContext()->drawSelf(area);
 
 			// draw extra stuff on top
 			if (scene->getCapture())
-				scene->getCapture()->drawTop(view->rect);
+				scene->getCapture()->drawTop(area);
 			else if (Button* but = dynamic_cast<Button*>(scene->select); mouseLast && but)
-				drawTooltip(but, view->rect);
+				drawTooltip(but, area);
+			if (stats)
+				drawFrameStats(*stats, statLines, statRect, area);
 
+			uint64 start = SDL_GetPerformanceCounter();
 			renderer->finishDraw(view);
+			presentTicks += SDL_GetPerformanceCounter() - start;
 		} catch (const Renderer::ErrorSkip&) {}
 	}
+	uint64 start = SDL_GetPerformanceCounter();
 	renderer->finishRender();
+	presentTicks += SDL_GetPerformanceCounter() - start;
 }
 
 bool DrawSys::drawPicture(const Picture* wgt, const Recti& view) {
@@ -257,8 +515,10 @@ bool DrawSys::drawPicture(const Picture* wgt, const Recti& view) {
 		Recti frame = wgt->frame();
 		if (wgt->showBG)
 			renderer->drawRect(blank, rect, frame, colors[uint8(wgt->color())]);
-		if (wgt->tex)
+		if (wgt->tex) {
+			wgt->tex->lastUse = this->frame;
 			renderer->drawRect(wgt->tex, wgt->texRect(), frame, colors[uint8(Color::texture)]);
+		}
 		return true;
 	}
 	return false;
@@ -286,8 +546,28 @@ void DrawSys::drawProgressBar(const ProgressBar* wgt, const Recti& view) {
 }
 
 void DrawSys::drawLabel(const Label* wgt, const Recti& view) {
-	if (drawPicture(wgt, view) && wgt->getTextTex())
-		renderer->drawRect(wgt->getTextTex(), wgt->textRect(), wgt->textFrame(), colors[uint8(Color::text)]);
+	if (drawPicture(wgt, view))
+		drawText(wgt->getTextLine(), wgt->textRect().pos(), wgt->textFrame(), colors[uint8(Color::text)]);
+}
+
+void DrawSys::drawText(const TextLine& line, ivec2 pos, const Recti& frame, const vec4& color) {
+	const FontSet::Atlas* atlas = fonts.findAtlas(line.height);
+	if (!atlas || frame.empty())
+		return;
+
+	// each glyph is a frame over its page placed so that the glyph lands at the pen position
+	for (auto [ch, x] : line.glyphs) {
+		umap<char32_t, FontSet::Glyph>::const_iterator it = atlas->glyphs.find(ch);
+		if (it == atlas->glyphs.end() || it->second.rect.empty())
+			continue;
+
+		const FontSet::Glyph& glyph = it->second;
+		Recti dst(pos.x + x + glyph.ofs, pos.y, glyph.rect.size());
+		if (dst.x >= frame.end().x)
+			break;
+		if (const Texture* tex = atlas->pages[glyph.page].tex; tex && dst.overlaps(frame))
+			renderer->drawRect(tex, Recti(dst.pos() - glyph.rect.pos(), tex->getRes()), dst.intersect(frame), color);
+	}
 }
 
 void DrawSys::drawCaret(const Recti& rect, const Recti& frame, const Recti& view) {
@@ -310,8 +590,10 @@ void DrawSys::drawWindowArranger(const WindowArranger* wgt, const Recti& view) {
 void DrawSys::drawWaDisp(const Recti& rect, Color color, const Recti& text, const Texture* tex, const Recti& frame, const Recti& view) {
 	if (rect.overlaps(view)) {
 		renderer->drawRect(blank, rect, frame, colors[uint8(color)]);
-		if (tex)
+		if (tex) {
+			tex->lastUse = this->frame;
 			renderer->drawRect(tex, text, frame, colors[uint8(Color::text)]);
+		}
 	}
 }
 
@@ -349,12 +631,81 @@ void DrawSys::drawPopup(const Popup* box, const Recti& view) {
 
 void DrawSys::drawTooltip(Button* but, const Recti& view) {
 	const Texture* tip = but->getTooltip();
-	if (Recti rct = but->tooltipRect(); tip && rct.overlaps(view)) {
+	if (!tip)
+		return;
+	if (Recti rct = tooltipArea = but->tooltipRect(); rct.overlaps(view)) {
+		tip->lastUse = frame;
 		renderer->drawRect(blank, rct, view, colors[uint8(Color::tooltip)]);
 		renderer->drawRect(tip, Recti(rct.pos() + Button::tooltipMargin, tip->getRes()), rct, colors[uint8(Color::text)]);
 	}
 }
 
+void DrawSys::drawFrameStats(const FrameStats& stats, const vector<TextLine>& lines, const Recti& rect, const Recti& view) {
+	if (!rect.overlaps(view))
+		return;
+	renderer->drawRect(blank, rect, view, colorStatsBackground);
+
+	// stacked phase times per frame with the oldest on the left and markers for the interval between frames
+	Recti graph(rect.x + statsMargin, rect.y + statsMargin, int(FrameStats::historyLength) * statsBarWidth, statsGraphHeight);
+	Recti frame = graph.intersect(view);
+	float scale = float(graph.h) / statsGraphRange;
+	for (sizet i = 0; i < FrameStats::historyLength; ++i) {
+		const FrameStats::Frame& frm = stats.frame(FrameStats::historyLength - 1 - i);
+		int x = graph.x + int(i) * statsBarWidth, bottom = graph.end().y;
+		for (sizet p = 0; p < frm.phases.size() && bottom > graph.y; ++p)
+			if (int h = int(frm.phases[p] * scale); h > 0) {
+				renderer->drawRect(blank, Recti(x, bottom - h, statsBarWidth, h), frame, colorStatsPhases[p]);
+				bottom -= h;
+			}
+		if (frm.interval > 0.f)
+			renderer->drawRect(blank, Recti(x, std::max(graph.end().y - int(frm.interval * scale), graph.y), statsBarWidth, 1), frame, colorStatsMarker);
+	}
+	renderer->drawRect(blank, Recti(graph.x, graph.end().y - int(1000.f / 60.f * scale), graph.w, 1), frame, colorStatsMarker);
+
+	ivec2 pos(graph.x, graph.end().y + statsMargin);
+	Recti textFrame = rect.intersect(view);
+	for (sizet i = 0; i < lines.size(); ++i, pos.y += statsLineHeight)
+		drawText(lines[i], pos, textFrame, i && i <= colorStatsPhases.size() ? colorStatsPhases[i - 1] : colors[uint8(Color::text)]);
+}
+
+vector<TextLine> DrawSys::frameStatsText(const FrameStats& stats) {
+	static_assert(colorStatsPhases.size() == sizet(FrameStats::Phase::max));
+	auto msStr = [](float ms) -> string { return toStr(uint(ms)) + '.' + toStr(uint(ms * 10.f) % 10) + " ms"; };
+	FrameStats::Frame avg = stats.average();
+	vector<TextLine> lines;
+	lines.reserve(FrameStats::phaseNames.size() + Texture::ownerNames.size() + 4);
+	lines.push_back(layoutText("frame " + msStr(avg.interval) + ", max " + msStr(stats.maxInterval()), statsLineHeight));
+	for (sizet i = 0; i < FrameStats::phaseNames.size(); ++i)
+		lines.push_back(layoutText(FrameStats::phaseNames[i] + " "s + msStr(avg.phases[i]), statsLineHeight));
+	Renderer::TexStats tst = renderer->getTexTotals();
+	lines.push_back(layoutText("textures " + toStr(tst.count) + ", gpu " + PicLim::memoryString(tst.gpuBytes, 2) + ", cpu " + PicLim::memoryString(tst.cpuBytes, 2) + (texBudget != UINTPTR_MAX ? " of " + PicLim::memoryString(texBudget, 2) : string()), statsLineHeight));
+	for (sizet i = 0; i < Texture::ownerNames.size(); ++i) {
+		const Renderer::TexStats& st = renderer->getTexStats(Texture::Owner(i));
+		lines.push_back(layoutText("  "s + Texture::ownerNames[i] + ' ' + toStr(st.count) + ", " + PicLim::memoryString(st.gpuBytes + st.cpuBytes, 2), statsLineHeight));
+	}
+	lines.push_back(layoutText("loader queue " + toStr(stats.loaderQueue) + ", previews " + toStr(stats.previewQueue), statsLineHeight));
+	if (const Renderer::GpuTimes& gpu = renderer->getGpuTimes(); gpu.valid) {
+		string line = "gpu";
+		for (sizet i = 0; i < Renderer::gpuPassNames.size(); ++i)
+			line += (i ? ", "s : " "s) + Renderer::gpuPassNames[i] + ' ' + msStr(gpu.ms[i]);
+		lines.push_back(layoutText(line, statsLineHeight));
+	}
+	return lines;
+}
+
+Recti DrawSys::frameStatsRect(const vector<TextLine>& lines) const {
+	int width = int(FrameStats::historyLength) * statsBarWidth;
+	for (const TextLine& it : lines)
+		width = std::max(width, it.width);
+	ivec2 size(width + statsMargin * 2, statsGraphHeight + int(lines.size()) * statsLineHeight + statsMargin * 3);
+	// anchor to the view at the origin, or the top left one if the windows don't cover it, since the view map's order is arbitrary
+	umap<int, Renderer::View*>::const_iterator vit = findViewForPoint(ivec2(0));
+	if (vit == renderer->getViews().end())
+		vit = std::min_element(renderer->getViews().begin(), renderer->getViews().end(), [](const pair<const int, Renderer::View*>& a, const pair<const int, Renderer::View*>& b) -> bool { return a.second->rect.y != b.second->rect.y ? a.second->rect.y < b.second->rect.y : a.second->rect.x < b.second->rect.x; });
+	const Recti& view = vit->second->rect;
+	return Recti(view.end().x - size.x - statsMargin, view.y + statsMargin, size);
+}
+
 Widget* DrawSys::getSelectedWidget(Layout* box, ivec2 mPos) {
 	umap<int, Renderer::View*>::const_iterator vit = findViewForPoint(mPos);
 	if (vit == renderer->getViews().end())
@@ -373,10 +724,13 @@ void DrawSys::drawPictureAddr(const Picture* wgt, const Recti& view) {
 void DrawSys::drawLayoutAddr(const Layout* wgt, const Recti& view) {
 	renderer->drawSelRect(wgt, wgt->rect(), wgt->frame());	// invisible background to set selection area
 	for (Widget* it : wgt->getWidgets())
-		it->drawAddr(view);
+		if (it)
+			it->drawAddr(view);
 }
 
 void DrawSys::loadTexturesDirectoryThreaded(std::atomic_bool& running, uptr<PictureLoader> pl) {
+	Trace::Zone zone("loadTexturesDirectory");
+	zone.setPath(pl->curDir);
 	vector<fs::path> files = FileSys::listDir(pl->curDir, true, false, pl->showHidden);
 	auto [lim, mem, sizMag] = initLoadLimits(pl.get(), files);	// picture count limit, picture size limit, magnitude index
 	string progLim = pl->limitToStr(lim, mem, sizMag);
@@ -390,9 +744,11 @@ void DrawSys::loadTexturesDirectoryThreaded(std::atomic_bool& running, uptr<Pict
 			return;
 		pushEvent(SDL_USEREVENT_READER_PROGRESS, PictureLoader::progressText(pl->limitToStr(c, m, sizMag), progLim));
 
+		Trace::Zone izone("decode", pl->names[i]);
 		if (SDL_Surface* img = IMG_Load((pl->curDir / files[i]).u8string().c_str())) {
+			izone.setBytes(uptrt(img->pitch) * uptrt(img->h));
 			pl->pics.emplace_back(i, img);
-			m += uptrt(img->w) * uptrt(img->h) * uptrt(img->format->BytesPerPixel);
+			m += pl->textureSize(uptrt(img->w) * uptrt(img->h));
 			++c;
 		}
 	}
@@ -401,6 +757,8 @@ void DrawSys::loadTexturesDirectoryThreaded(std::atomic_bool& running, uptr<Pict
 }
 
 void DrawSys::loadTexturesArchiveThreaded(std::atomic_bool& running, uptr<PictureLoader> pl) {
+	Trace::Zone zone("loadTexturesArchive");
+	zone.setPath(pl->curDir);
 	mapFiles files = FileSys::listArchivePictures(pl->curDir, pl->names);
 	auto [start, end, lim, mem, sizMag] = initLoadLimits(pl.get(), files);
 	string progLim = pl->limitToStr(lim, mem, sizMag);
@@ -421,7 +779,7 @@ void DrawSys::loadTexturesArchiveThreaded(std::atomic_bool& running, uptr<Pictur
 		if (pair<sizet, uptrt>& ent = files[pname]; ent.first >= start && ent.first < end)
 			if (SDL_Surface* img = FileSys::loadArchivePicture(arch, entry)) {
 				pl->pics.emplace_back(ent.first, img);
-				m += ent.second;
+				m += pl->textureSize(ent.second);
 				++c;
 			}
 	}
@@ -430,6 +788,53 @@ void DrawSys::loadTexturesArchiveThreaded(std::atomic_bool& running, uptr<Pictur
 	running = false;
 }
 
+// evicted reader pages come back by being decoded again
+void DrawSys::reloadTexturesDirectoryThreaded(std::atomic_bool& running, uptr<PictureLoader> pl) {
+	Trace::Zone zone("reloadTexturesDirectory");
+	zone.setPath(pl->curDir);
+	for (sizet i = 0; i < pl->names.size(); ++i) {
+		if (!running)
+			return;
+
+		Trace::Zone izone("decode", pl->names[i]);
+		if (SDL_Surface* img = IMG_Load((pl->curDir / fs::u8path(pl->names[i])).u8string().c_str())) {
+			izone.setBytes(uptrt(img->pitch) * uptrt(img->h));
+			pl->pics.emplace_back(i, img);
+		}
+	}
+	pushEvent(SDL_USEREVENT_READER_RELOADED, pl.release());
+	running = false;
+}
+
+void DrawSys::reloadTexturesArchiveThreaded(std::atomic_bool& running, uptr<PictureLoader> pl) {
+	Trace::Zone zone("reloadTexturesArchive");
+	zone.setPath(pl->curDir);
+	archive* arch = FileSys::openArchive(pl->curDir);
+	if (!arch) {
+		pushEvent(SDL_USEREVENT_READER_RELOADED, pl.release());	// report every page as missing
+		running = false;
+		return;
+	}
+
+	umap<string, sizet> ids;
+	for (sizet i = 0; i < pl->names.size(); ++i)
+		ids.emplace(pl->names[i], i);
+	for (archive_entry* entry; !ids.empty() && !archive_read_next_header(arch, &entry);) {
+		if (!running) {
+			archive_read_free(arch);
+			return;
+		}
+		if (umap<string, sizet>::iterator it = ids.find(archive_entry_pathname_utf8(entry)); it != ids.end()) {
+			if (SDL_Surface* img = FileSys::loadArchivePicture(arch, entry))
+				pl->pics.emplace_back(it->second, img);
+			ids.erase(it);
+		}
+	}
+	archive_read_free(arch);
+	pushEvent(SDL_USEREVENT_READER_RELOADED, pl.release());
+	running = false;
+}
+
 tuple<sizet, uptrt, uint8> DrawSys::initLoadLimits(const PictureLoader* pl, vector<fs::path>& files) {
 	if (pl->picLim.type != PicLim::Type::none)
 		if (vector<fs::path>::iterator it = std::find(files.begin(), files.end(), fs::u8path(pl->firstPic)); it != files.end())
@@ -471,10 +876,10 @@ tuple<sizet, sizet, sizet, uptrt, uint8> DrawSys::initLoadLimits(PictureLoader*
 		sizet end;
 		if (pl->fwd) {
 			end = start;
-			for (uptrt m = 0; end < files.size() && m < pl->picLim.getSize(); m += files.at(pl->names[end]).second, ++end);
+			for (uptrt m = 0; end < files.size() && m < pl->picLim.getSize(); m += pl->textureSize(files.at(pl->names[end]).second), ++end);
 		} else {
 			end = start + 1;
-			for (uptrt m = 0; start > 0 && m < pl->picLim.getSize(); m += files.at(pl->names[start]).second, --start);
+			for (uptrt m = 0; start > 0 && m < pl->picLim.getSize(); m += pl->textureSize(files.at(pl->names[start]).second), --start);
 		}
 		return tuple(start, end, files.size(), pl->picLim.getSize(), PicLim::memSizeMag(pl->picLim.getSize()));
 	} }
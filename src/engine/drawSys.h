@@ -9,10 +9,35 @@
 #endif
 #include <atomic>
 
-// loads different font sizes from one file
+// loads different font sizes from one file and caches their glyphs in texture atlases
 class FontSet {
 public:
 	static constexpr int fontTestHeight = 100;
+	static constexpr int atlasPageSize = 1024;
+
+	struct Glyph {
+		Recti rect = Recti(0);	// area in the atlas page, empty if there's nothing to draw
+		int ofs = 0;			// horizontal offset of the image from the pen position
+		int advance = 0;
+		uint page = UINT_MAX;	// UINT_MAX until rasterized
+	};
+
+	struct AtlasPage {
+		SDL_Surface* img;
+		Texture* tex = nullptr;
+		ivec2 cursor = ivec2(0);	// where the next glyph goes
+		Recti dirty = Recti(0);		// area in which the texture is behind the surface
+
+		AtlasPage(SDL_Surface* surface);
+	};
+
+	// glyphs of one font height
+	struct Atlas {
+		umap<char32_t, Glyph> glyphs;
+		umap<uint64, int> kerning;
+		vector<AtlasPage> pages;
+		int lineHeight = 0;
+	};
 private:
 	static constexpr char fontTestString[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ`~!@#$%^&*()_+-=[]{}'\\\"|;:,.<>/?";
 
@@ -22,6 +47,7 @@ private:
 	fs::path file;
 	umap<int, TTF_Font*> fonts;
 #endif
+	umap<int, Atlas> atlases;
 	float heightScale;	// for scaling down font size to fit requested height
 
 public:
@@ -32,11 +58,28 @@ public:
 	void clear();
 #endif
 	TTF_Font* getFont(int height);
-	int length(const char* text, int height);
-	int length(char* text, sizet length, int height);
+	int length(string_view text, int height);
+	TextLine layout(string_view text, int height);
+	const Atlas* findAtlas(int height) const;
+	void uploadAtlases(Renderer* renderer);
+	void freeAtlases(Renderer* renderer);
+
+private:
+	Atlas& getAtlas(int height);
+	Glyph& getGlyph(Atlas& atlas, char32_t ch, int height);
+	int getKerning(Atlas& atlas, char32_t prev, char32_t ch, int height);
+	void rasterize(Atlas& atlas, Glyph& glyph, char32_t ch, int height);
+	static char32_t nextChar(string_view text, sizet& i);
 };
 
+inline FontSet::AtlasPage::AtlasPage(SDL_Surface* surface) :
+	img(surface)
+{}
+
 inline FontSet::~FontSet() {
+	for (auto& [height, atlas] : atlases)
+		for (AtlasPage& it : atlas.pages)
+			SDL_FreeSurface(it.img);
 #if SDL_TTF_VERSION_ATLEAST(2, 0, 18)
 	TTF_CloseFont(font);
 #else
@@ -44,6 +87,11 @@ inline FontSet::~FontSet() {
 #endif
 }
 
+inline const FontSet::Atlas* FontSet::findAtlas(int height) const {
+	umap<int, Atlas>::const_iterator it = atlases.find(height);
+	return it != atlases.end() ? &it->second : nullptr;
+}
+
 // data needed to load pictures
 struct PictureLoader {
 	vector<string> names;
@@ -51,22 +99,48 @@ struct PictureLoader {
 	fs::path curDir;
 	string firstPic;
 	PicLim picLim;
+	float texBytesPerPixel;	// how much a reader texture takes up in the renderer
 	bool fwd, showHidden;
 
-	PictureLoader(fs::path cdrc, string pfirst, const PicLim& plim, bool forward, bool hidden);
+	PictureLoader(fs::path cdrc, string pfirst, const PicLim& plim, bool forward, bool hidden, float bytesPerPixel = 4.f);
 	~PictureLoader();
 
 	vector<pair<sizet, SDL_Surface*>> extractPics();
+	uptrt textureSize(uptrt pixels) const;
 	string limitToStr(uptrt c, uptrt m, sizet mag) const;
 	static char* progressText(string_view val, string_view lim);
 };
 
+// a texture that its owner is able to let go of and bring back later
+struct ResidentTexture {
+	const Texture* tex;
+	Texture::Owner owner;	// kept aside since the texture is gone once it's been evicted
+	sizet id;		// for the owner to find it again
+	sizet distance;	// items between it and the view
+};
+
 // handles the drawing
 class DrawSys {
 public:
 	static constexpr int cursorHeight = 20;
 private:
+	static constexpr float deviceMemoryShare = 0.5f;	// of the device's memory that textures may use if no budget is set
+	static constexpr float evictTarget = 0.9f;			// fraction of the budget to get down to, so that the next texture doesn't push it over again
 	static constexpr vec4 colorPopupDim = vec4(0.f, 0.f, 0.f, 0.5f);
+	static constexpr vec4 colorStatsBackground = vec4(0.f, 0.f, 0.f, 0.7f);
+	static constexpr vec4 colorStatsMarker = vec4(1.f, 1.f, 1.f, 0.6f);
+	static constexpr array<vec4, 5> colorStatsPhases = {
+		vec4(0.2f, 0.6f, 1.f, 1.f),
+		vec4(0.9f, 0.5f, 0.1f, 1.f),
+		vec4(0.6f, 0.9f, 0.3f, 1.f),
+		vec4(0.9f, 0.9f, 0.3f, 1.f),
+		vec4(0.8f, 0.3f, 0.8f, 1.f)
+	};
+	static constexpr int statsLineHeight = 16;
+	static constexpr int statsMargin = 6;
+	static constexpr int statsBarWidth = 2;
+	static constexpr int statsGraphHeight = 64;
+	static constexpr float statsGraphRange = 1000.f / 30.f;	// milliseconds that fill the graph
 
 	Renderer* renderer = nullptr;
 	ivec2 viewRes = ivec2(0);
@@ -74,12 +148,24 @@ private:
 	FontSet fonts;
 	umap<string, Texture*> texes;
 	const Texture* blank;
+	vector<Recti> damage;	// areas that changed since the last frame
+	Recti tooltipArea = Recti(0);	// where the last tooltip was drawn
+	uint64 presentTicks = 0;	// time spent in finishing the last frame
+	uptrt texBudget = UINTPTR_MAX;	// bytes of textures to keep around
+	uint32 frame = 0;	// number of the current or last drawn frame
+	float readerBytesPerPixel = 4.f;	// measured from the last reader textures that were around
+	bool redraw = true;	// whether everything needs to be drawn again
 
 public:
-	DrawSys(const umap<int, SDL_Window*>& windows, Settings* sets, const FileSys* fileSys, int iconSize);
+	DrawSys(const umap<int, SDL_Window*>& windows, Settings::Renderer rnd, Settings* sets, const FileSys* fileSys, int iconSize);
 	~DrawSys();
 
 	ivec2 getViewRes() const;
+	void invalidate();
+	void invalidate(const Recti& area);
+	void invalidate(const Widget* wgt);
+	void invalidateTooltip(Button* but);
+	bool needsRedraw() const;
 	const Recti& getView(int id) const;
 	void updateView();
 	int findPointInView(ivec2 pos) const;
@@ -89,23 +175,32 @@ public:
 	int textLength(const string& text, int height);
 	int textLength(char* text, sizet length, int height);
 	int textLength(string& text, sizet length, int height);
+	TextLine layoutText(string_view text, int height);
 	void setFont(string_view font, Settings* sets, const FileSys* fileSys);
 #if !SDL_TTF_VERSION_ATLEAST(2, 0, 18)
 	void clearFonts();
 #endif
 	const Texture* texture(const string& name) const;
 	vector<pair<string, Texture*>> transferPictures(PictureLoader* pl);
-	Texture* texFromImg(SDL_Surface* img);
+	Texture* texFromImg(SDL_Surface* img, Texture::Owner owner);
 	void freeTexture(Texture* tex);
+	float getReaderBytesPerPixel() const;
+	uptrt textureMemory(Texture::Owner owner) const;
+	void logTextureMemory() const;
+	uptrt getTextureBudget() const;
+	bool overTextureBudget() const;
+	vector<ResidentTexture> pickEvictions(vector<ResidentTexture> cands) const;
 	void setCompression(bool on);
 	void getAdditionalSettings(bool& compression, vector<pair<u32vec2, string>>& devices);
 
-	void drawWidgets(Scene* scene, bool mouseLast);
+	void drawWidgets(Scene* scene, bool mouseLast, const FrameStats* stats);
+	uint64 getPresentTicks() const;
 	bool drawPicture(const Picture* wgt, const Recti& view);
 	void drawCheckBox(const CheckBox* wgt, const Recti& view);
 	void drawSlider(const Slider* wgt, const Recti& view);
 	void drawProgressBar(const ProgressBar* wgt, const Recti& view);
 	void drawLabel(const Label* wgt, const Recti& view);
+	void drawText(const TextLine& line, ivec2 pos, const Recti& frame, const vec4& color);
 	void drawCaret(const Recti& rect, const Recti& frame, const Recti& view);
 	void drawWindowArranger(const WindowArranger* wgt, const Recti& view);
 	void drawWaDisp(const Recti& rect, Color color, const Recti& text, const Texture* tex, const Recti& frame, const Recti& view);
@@ -113,6 +208,7 @@ public:
 	void drawReaderBox(const ReaderBox* box, const Recti& view);
 	void drawPopup(const Popup* box, const Recti& view);
 	void drawTooltip(Button* but, const Recti& view);
+	void drawFrameStats(const FrameStats& stats, const vector<TextLine>& lines, const Recti& rect, const Recti& view);
 
 	Widget* getSelectedWidget(Layout* box, ivec2 mPos);
 	void drawPictureAddr(const Picture* wgt, const Recti& view);
@@ -124,16 +220,57 @@ public:
 	Texture* renderText(const string& text, int height, uint length);
 	static void loadTexturesDirectoryThreaded(std::atomic_bool& running, uptr<PictureLoader> pl);
 	static void loadTexturesArchiveThreaded(std::atomic_bool& running, uptr<PictureLoader> pl);
+	static void reloadTexturesDirectoryThreaded(std::atomic_bool& running, uptr<PictureLoader> pl);
+	static void reloadTexturesArchiveThreaded(std::atomic_bool& running, uptr<PictureLoader> pl);
 private:
 	static tuple<sizet, uptrt, uint8> initLoadLimits(const PictureLoader* pl, vector<fs::path>& files);
 	static tuple<sizet, sizet, sizet, uptrt, uint8> initLoadLimits(PictureLoader* pl, const mapFiles& files);
 	umap<int, Renderer::View*>::const_iterator findViewForPoint(ivec2 pos) const;
+	Texture* touch(Texture* tex) const;
+	void measureReaderTextures();
+	vector<TextLine> frameStatsText(const FrameStats& stats);
+	Recti frameStatsRect(const vector<TextLine>& lines) const;
 };
 
 inline ivec2 DrawSys::getViewRes() const {
 	return viewRes;
 }
 
+inline float DrawSys::getReaderBytesPerPixel() const {
+	return readerBytesPerPixel;
+}
+
+inline uptrt DrawSys::textureMemory(Texture::Owner owner) const {
+	const Renderer::TexStats& st = renderer->getTexStats(owner);
+	return st.cpuBytes + st.gpuBytes;
+}
+
+inline uptrt DrawSys::getTextureBudget() const {
+	return texBudget;
+}
+
+inline bool DrawSys::overTextureBudget() const {
+	Renderer::TexStats tst = renderer->getTexTotals();
+	return tst.cpuBytes + tst.gpuBytes > texBudget;
+}
+
+inline void DrawSys::invalidate() {
+	redraw = true;
+}
+
+inline void DrawSys::invalidate(const Recti& area) {
+	if (!redraw && !area.empty())
+		damage.push_back(area);
+}
+
+inline uint64 DrawSys::getPresentTicks() const {
+	return presentTicks;
+}
+
+inline bool DrawSys::needsRedraw() const {
+	return redraw || !damage.empty() || renderer->hasPendingUploads();
+}
+
 inline const Recti& DrawSys::getView(int id) const {
 	return renderer->getViews().at(id)->rect;
 }
@@ -151,19 +288,23 @@ inline int DrawSys::textLength(const char* text, int height) {
 }
 
 inline int DrawSys::textLength(const string& text, int height) {
-	return fonts.length(text.c_str(), height);
+	return fonts.length(text, height);
 }
 
 inline int DrawSys::textLength(char* text, sizet length, int height) {
-	return fonts.length(text, length, height);
+	return fonts.length(string_view(text, length), height);
 }
 
 inline int DrawSys::textLength(string& text, sizet length, int height) {
-	return fonts.length(text.data(), length, height);
+	return fonts.length(string_view(text.data(), length), height);
+}
+
+inline TextLine DrawSys::layoutText(string_view text, int height) {
+	return fonts.layout(text, height);
 }
 
 inline Texture* DrawSys::renderText(const char* text, int height) {
-	return renderer->texFromText(TTF_RenderUTF8_Blended(fonts.getFont(height), text, { 255, 255, 255, 255 }));
+	return touch(renderer->texFromText(TTF_RenderUTF8_Blended(fonts.getFont(height), text, { 255, 255, 255, 255 })));
 }
 
 inline Texture* DrawSys::renderText(const string& text, int height) {
@@ -171,18 +312,20 @@ inline Texture* DrawSys::renderText(const string& text, int height) {
 }
 
 inline Texture* DrawSys::renderText(const char* text, int height, uint length) {
-	return renderer->texFromText(TTF_RenderUTF8_Blended_Wrapped(fonts.getFont(height), text, { 255, 255, 255, 255 }, length));
+	return touch(renderer->texFromText(TTF_RenderUTF8_Blended_Wrapped(fonts.getFont(height), text, { 255, 255, 255, 255 }, length)));
 }
 
 inline Texture* DrawSys::renderText(const string& text, int height, uint length) {
 	return renderText(text.c_str(), height, length);
 }
 
-inline Texture* DrawSys::texFromImg(SDL_Surface* img) {
-	return renderer->texFromImg(img);
+inline Texture* DrawSys::texFromImg(SDL_Surface* img, Texture::Owner owner) {
+	return touch(renderer->texFromImg(img, owner));
 }
 
 inline void DrawSys::freeTexture(Texture* tex) {
+	if (tex->getOwner() == Texture::Owner::reader)
+		measureReaderTextures();
 	renderer->freeTexture(tex);
 }
 
@@ -198,6 +341,13 @@ inline umap<int, Renderer::View*>::const_iterator DrawSys::findViewForPoint(ivec
 	return std::find_if(renderer->getViews().begin(), renderer->getViews().end(), [&pos](const pair<int, Renderer::View*>& it) -> bool { return it.second->rect.contains(pos); });
 }
 
+// a new texture counts as just used, so that it doesn't get evicted before it's had the chance to be drawn
+inline Texture* DrawSys::touch(Texture* tex) const {
+	if (tex)
+		tex->lastUse = frame;
+	return tex;
+}
+
 #if !SDL_TTF_VERSION_ATLEAST(2, 0, 18)
 inline void DrawSys::clearFonts() {
 	fonts.clear();
@@ -1,6 +1,7 @@
 #include "fileSys.h"
 #include "drawSys.h"
 #include "utils/compare.h"
+#include "utils/trace.h"
 #include <archive.h>
 #include <archive_entry.h>
 #include <queue>
@@ -11,6 +12,8 @@
 #include <SDL2/SDL_image.h>
 #include <dirent.h>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <fontconfig/fontconfig.h>
 #endif
 
@@ -76,7 +79,9 @@ vector<IniLine> IniLine::readLines(string_view text) {
 
 // FILE SYS
 
-FileSys::FileSys() {
+FileSys::FileSys(const fs::path& settingsDir, bool noSaving) :
+	readOnly(noSaving)
+{
 	// set up file/directory path constants
 	if (char* path = SDL_GetBasePath()) {
 #ifdef _WIN32
@@ -96,6 +101,8 @@ FileSys::FileSys() {
 	dirSets = fs::u8path(getenv("HOME")) / ".local/share/vertiread";
 	dirConfs = dirBase / "share/vertiread";
 #endif
+	if (!settingsDir.empty())
+		dirSets = settingsDir;
 
 	try {
 		std::regex rgx(R"r(log_[\d-]+\.txt)r", std::regex::icase | std::regex::optimize);
@@ -178,6 +185,8 @@ bool FileSys::getLastPage(string_view book, string& drc, string& fname) const {
 }
 
 bool FileSys::saveLastPage(string_view book, string_view drc, string_view fname) const {
+	if (readOnly)
+		return false;
 	fs::path path = dirSets / fileBooks;
 	vector<string> lines = readFileLines(path, false);
 	vector<string>::iterator li = std::find_if(lines.begin(), lines.end(), [book](const string& it) -> bool { vector<string> words = strUnenclose(it); return words.size() >= 2 && words[0] == book; });
@@ -200,14 +209,21 @@ Settings* FileSys::loadSettings() const {
 				sets->screen = strToEnum(Settings::screenModeNames, il.getVal(), Settings::defaultScreenMode);
 			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordResolution))
 				sets->resolution = toVec<ivec2>(il.getVal());
-			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordRenderer))
+			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordRenderer)) {
+				// headless needs the dummy video driver, which only gets set up from the command line
 				sets->renderer = strToEnum(Settings::rendererNames, il.getVal(), Settings::defaultRenderer);
-			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordDevice))
+				if (sets->renderer == Settings::Renderer::null)
+					sets->renderer = Settings::defaultRenderer;
+			} else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordDevice))
 				sets->device = toVec<u32vec2>(il.getVal(), 0, 0x10);
 			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordCompression))
 				sets->compression = toBool(il.getVal());
 			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordVSync))
 				sets->vsync = toBool(il.getVal());
+			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordMaxFps))
+				sets->maxFps = toNum<uint>(il.getVal());
+			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordTextureBudget))
+				sets->textureBudget = toNum<uint>(il.getVal());
 			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordGpuSelecting))
 				sets->gpuSelecting = toBool(il.getVal());
 			else if (!SDL_strcasecmp(il.getPrp().c_str(), iniKeywordDirection))
@@ -245,6 +261,8 @@ Settings* FileSys::loadSettings() const {
 }
 
 void FileSys::saveSettings(const Settings* sets) const {
+	if (readOnly)
+		return;
 	fs::path path = dirSets / fileSettings;
 	std::ofstream ofh(path, std::ios::binary);
 	if (!ofh.good()) {
@@ -260,6 +278,8 @@ void FileSys::saveSettings(const Settings* sets) const {
 	IniLine::writeVal(ofh, iniKeywordDevice, toStr<0x10>(sets->device));
 	IniLine::writeVal(ofh, iniKeywordCompression, toStr(sets->compression));
 	IniLine::writeVal(ofh, iniKeywordVSync, toStr(sets->vsync));
+	IniLine::writeVal(ofh, iniKeywordMaxFps, sets->maxFps);
+	IniLine::writeVal(ofh, iniKeywordTextureBudget, sets->textureBudget);
 	IniLine::writeVal(ofh, iniKeywordGpuSelecting, toStr(sets->gpuSelecting));
 	IniLine::writeVal(ofh, iniKeywordZoom, sets->zoom);
 	IniLine::writeVal(ofh, iniKeywordPictureLimit, PicLim::names[uint8(sets->picLim.type)], ' ', sets->picLim.getCount(), ' ', PicLim::memoryString(sets->picLim.getSize()));
@@ -317,6 +337,8 @@ array<Binding, Binding::names.size()> FileSys::getBindings() const {
 }
 
 void FileSys::saveBindings(const array<Binding, Binding::names.size()>& bindings) const {
+	if (readOnly)
+		return;
 	fs::path path = dirSets / fileBindings;
 	std::ofstream ofh(path, std::ios::binary);
 	if (!ofh.good()) {
@@ -536,12 +558,16 @@ vector<string> FileSys::listArchive(const fs::path& file) {
 }
 
 mapFiles FileSys::listArchivePictures(const fs::path& file, vector<string>& names) {
+	Trace::Zone zone("listArchivePictures");
+	zone.setPath(file);
 	mapFiles files;
+	uptrt total = 0;
 	if (archive* arch = openArchive(file)) {
 		for (archive_entry* entry; !archive_read_next_header(arch, &entry);) {
 			if (SDL_Surface* img = loadArchivePicture(arch, entry)) {
 				string pname = archive_entry_pathname_utf8(entry);
-				files.emplace(pname, pair(SIZE_MAX, uptrt(img->w) * uptrt(img->h) * uptrt(img->format->BytesPerPixel)));
+				total += uptrt(img->w) * uptrt(img->h) * uptrt(img->format->BytesPerPixel);
+				files.emplace(pname, pair(SIZE_MAX, uptrt(img->w) * uptrt(img->h)));
 				names.push_back(std::move(pname));
 				SDL_FreeSurface(img);
 			}
@@ -552,6 +578,7 @@ mapFiles FileSys::listArchivePictures(const fs::path& file, vector<string>& name
 		for (sizet i = 0; i < names.size(); ++i)
 			files[names[i]].first = i;
 	}
+	zone.setBytes(total);
 	return files;
 }
 
@@ -560,9 +587,21 @@ SDL_Surface* FileSys::loadArchivePicture(archive* arch, archive_entry* entry) {
 	if (bsiz <= 0)
 		return nullptr;
 
+	Trace::Zone zone("loadArchivePicture");
+	if (Trace::on())
+		zone.setFile(archive_entry_pathname_utf8(entry));
+	zone.setBytes(bsiz);
 	uptr<uint8[]> buffer = std::make_unique<uint8[]>(bsiz);
-	int64 size = archive_read_data(arch, buffer.get(), bsiz);
+	int64 size;
+	{
+		Trace::Zone dzone("decompress");
+		dzone.setBytes(bsiz);
+		size = archive_read_data(arch, buffer.get(), bsiz);
+	}
+	Trace::Zone izone("decode");
 	SDL_Surface* pic = size > 0 ? IMG_Load_RW(SDL_RWFromMem(buffer.get(), size), SDL_TRUE) : nullptr;
+	if (pic)
+		izone.setBytes(uptrt(pic->pitch) * uptrt(pic->h));
 	return pic;
 }
 
@@ -584,6 +623,22 @@ void FileSys::moveContentThreaded(std::atomic_bool& running, fs::path src, fs::p
 	running = false;
 }
 
+bool FileSys::dropCache(const fs::path& path) {
+#ifdef POSIX_FADV_DONTNEED
+	vector<fs::path> files = fs::is_directory(path) ? listDir(path, true, false) : vector<fs::path>{ path.filename() };
+	fs::path drc = fs::is_directory(path) ? path : parentPath(path);
+	for (const fs::path& it : files)
+		if (int fd = ::open((drc / it).c_str(), O_RDONLY); fd != -1) {
+			fdatasync(fd);
+			posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+			::close(fd);
+		}
+	return true;
+#else
+	return false;
+#endif
+}
+
 fs::path FileSys::findFont(string_view font) const {
 	if (fs::path path = fs::u8path(font); isFont(path))
 		return path;
@@ -105,6 +105,8 @@ private:
 	static constexpr char iniKeywordDevice[] = "device";
 	static constexpr char iniKeywordCompression[] = "compression";
 	static constexpr char iniKeywordVSync[] = "vsync";
+	static constexpr char iniKeywordMaxFps[] = "max_fps";
+	static constexpr char iniKeywordTextureBudget[] = "texture_budget";
 	static constexpr char iniKeywordGpuSelecting[] = "gpu_selecting";
 	static constexpr char iniKeywordDirection[] = "direction";
 	static constexpr char iniKeywordZoom[] = "zoom";
@@ -133,8 +135,9 @@ private:
 	fs::path dirSets;	// settings directory
 	fs::path dirConfs;	// internal config directory
 	std::ofstream logFile;
+	bool readOnly;		// settings, bindings and last pages don't get written
 public:
-	FileSys();
+	FileSys(const fs::path& settingsDir, bool noSaving);	// uses the default settings directory if the path is empty
 	~FileSys();
 
 	vector<string> getAvailableThemes() const;
@@ -159,10 +162,11 @@ public:
 
 	static archive* openArchive(const fs::path& file);
 	static vector<string> listArchive(const fs::path& file);
-	static mapFiles listArchivePictures(const fs::path& file, vector<string>& names);
+	static mapFiles listArchivePictures(const fs::path& file, vector<string>& names);	// picture names to their sorted index and pixel count
 	static SDL_Surface* loadArchivePicture(archive* arch, archive_entry* entry);
 
 	static void moveContentThreaded(std::atomic_bool& running, fs::path src, fs::path dst);
+	static bool dropCache(const fs::path& path);	// evict a file or a directory's files from the page cache, returns false if unsupported
 	const fs::path& getDirSets() const;
 	fs::path dirIcons() const;
 
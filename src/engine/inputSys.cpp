@@ -166,8 +166,10 @@ SDL_MouseButtonEvent InputSys::toMouseEvent(const SDL_TouchFingerEvent& fin, uin
 void InputSys::tick() const {
 	// handle key hold
 	for (sizet i = uint8(Binding::holders); i < bindings.size(); ++i)
-		if (float amt = 1.f; isPressed(bindings[i], amt))
+		if (float amt = 1.f; isPressed(bindings[i], amt)) {
 			World::srun(bindings[i].acall, amt);
+			World::drawSys()->invalidate();
+		}
 }
 
 void InputSys::checkBindingsK(SDL_Scancode key, uint8 repeat) const {
@@ -0,0 +1,159 @@
+#include "inputTrace.h"
+
+InputTrace::InputTrace(const fs::path& file, bool replay) :
+	replaying(replay)
+{
+	uint32 eventSize = sizeof(SDL_Event);
+	if (!replaying) {
+		ofh.open(file, std::ios::binary);
+		if (!ofh)
+			throw std::runtime_error("Failed to open input trace " + file.u8string());
+		ofh.write(signature, sizeof(signature) - 1);
+		ofh.write(reinterpret_cast<const char*>(&eventSize), sizeof(eventSize));
+		return;
+	}
+
+	std::ifstream ifh(file, std::ios::binary);
+	if (!ifh)
+		throw std::runtime_error("Failed to open input trace " + file.u8string());
+	array<char, sizeof(signature) - 1> sig;
+	uint32 size = 0;
+	if (!ifh.read(sig.data(), sig.size()) || !ifh.read(reinterpret_cast<char*>(&size), sizeof(size)) || !std::equal(sig.begin(), sig.end(), signature) || size != eventSize)
+		throw std::runtime_error("Invalid input trace " + file.u8string());
+	for (Record rec; ifh.read(reinterpret_cast<char*>(&rec.time), sizeof(rec.time)) && ifh.read(reinterpret_cast<char*>(&rec.event), sizeof(rec.event));)
+		records.push_back(rec);
+	logInfo("Replaying ", records.size(), " events from ", file);
+}
+
+InputTrace::~InputTrace() {
+	if (replaying) {
+		if (!finished())
+			logError("Replay stopped with ", records.size() - next, " events left");
+		logTimes("frame", frameTimes);
+		logTimes("load", loadTimes);
+	}
+}
+
+void InputTrace::start(uint32 winId) {
+	origin = SDL_GetTicks();
+	windowId = winId;
+}
+
+void InputTrace::record(const SDL_Event& event) {
+	SDL_Event rec = SDL_Event();
+	if (syncPoint(event.type))
+		rec.type = event.type;	// the data it carries is of no use later
+	else if (recordable(event.type))
+		rec = event;
+	else
+		return;
+
+	uint32 time = SDL_GetTicks() - origin;
+	ofh.write(reinterpret_cast<const char*>(&time), sizeof(time));
+	ofh.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+}
+
+bool InputTrace::nextEvent(SDL_Event& event) {
+	// the events after a sync point keep their distance to it rather than to the start
+	while (waiting()) {
+		vector<pair<uint32, uint32>>::iterator it = std::find_if(reached.begin(), reached.end(), [this](const pair<uint32, uint32>& sp) -> bool { return sp.first == records[next].event.type; });
+		if (it == reached.end())
+			return false;
+		origin = it->second - records[next++].time;
+		reached.erase(it);
+	}
+	if (finished() || !SDL_TICKS_PASSED(SDL_GetTicks(), origin + records[next].time))
+		return false;
+
+	event = records[next++].event;
+	event.common.timestamp = SDL_GetTicks();
+	if (windowId)
+		switch (event.type) {
+		case SDL_WINDOWEVENT:
+			event.window.windowID = windowId;
+			break;
+		case SDL_KEYDOWN: case SDL_KEYUP:
+			event.key.windowID = windowId;
+			break;
+		case SDL_TEXTEDITING:
+			event.edit.windowID = windowId;
+			break;
+		case SDL_TEXTINPUT:
+			event.text.windowID = windowId;
+			break;
+		case SDL_MOUSEMOTION:
+			event.motion.windowID = windowId;
+			break;
+		case SDL_MOUSEBUTTONDOWN: case SDL_MOUSEBUTTONUP:
+			event.button.windowID = windowId;
+			break;
+		case SDL_MOUSEWHEEL:
+			event.wheel.windowID = windowId;
+			break;
+		case SDL_FINGERDOWN: case SDL_FINGERUP: case SDL_FINGERMOTION:
+			event.tfinger.windowID = windowId;
+		}
+	return true;
+}
+
+void InputTrace::reach(uint32 type) {
+	if (syncPoint(type))
+		reached.emplace_back(type, SDL_GetTicks());
+}
+
+void InputTrace::skipWait() {
+	logError("Replay diverged, skipping a sync point that didn't happen");
+	origin = SDL_GetTicks() - records[next++].time;
+}
+
+uint32 InputTrace::waitTime() const {
+	if (finished() || waiting())
+		return UINT32_MAX;
+	uint32 due = origin + records[next].time;
+	uint32 now = SDL_GetTicks();
+	return SDL_TICKS_PASSED(now, due) ? 0 : due - now;
+}
+
+void InputTrace::addFrame(uint64 ticks) {
+	if (replaying)
+		frameTimes.push_back(double(ticks) * 1000.0 / double(SDL_GetPerformanceFrequency()));
+}
+
+void InputTrace::startLoad() {
+	if (replaying)
+		loadStart = SDL_GetPerformanceCounter();
+}
+
+void InputTrace::finishLoad() {
+	if (loadStart) {
+		loadTimes.push_back(double(SDL_GetPerformanceCounter() - loadStart) * 1000.0 / double(SDL_GetPerformanceFrequency()));
+		loadStart = 0;
+	}
+}
+
+// events that carry pointers or depend on the connected devices can't be replayed
+bool InputTrace::recordable(uint32 type) {
+	switch (type) {
+	case SDL_QUIT: case SDL_WINDOWEVENT: case SDL_KEYDOWN: case SDL_KEYUP: case SDL_TEXTEDITING: case SDL_TEXTINPUT:
+	case SDL_MOUSEMOTION: case SDL_MOUSEBUTTONDOWN: case SDL_MOUSEBUTTONUP: case SDL_MOUSEWHEEL:
+	case SDL_JOYAXISMOTION: case SDL_JOYHATMOTION: case SDL_JOYBUTTONDOWN: case SDL_CONTROLLERAXISMOTION: case SDL_CONTROLLERBUTTONDOWN:
+	case SDL_FINGERDOWN: case SDL_FINGERUP: case SDL_FINGERMOTION:
+		return true;
+	}
+	return false;
+}
+
+// background work that the user had to wait for before continuing
+bool InputTrace::syncPoint(uint32 type) {
+	return type == SDL_USEREVENT_READER_FINISHED || type == SDL_USEREVENT_MOVE_FINISHED;
+}
+
+void InputTrace::logTimes(const char* name, vector<double>& times) {
+	if (times.empty()) {
+		logInfo("Replay ", name, " times: none");
+		return;
+	}
+	std::sort(times.begin(), times.end());
+	auto percentile = [&times](double p) -> string { return toStr(times[std::min(sizet(double(times.size()) * p), times.size() - 1)]); };
+	logInfo("Replay ", name, " times over ", times.size(), ": p50 ", percentile(0.5), " ms, p90 ", percentile(0.9), " ms, p99 ", percentile(0.99), " ms, max ", toStr(times.back()), " ms");
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "utils/utils.h"
+#include <fstream>
+
+// records input events with their timing to a file or feeds them back in, in which case frame and loading times are collected
+// the end of background work that blocks input is recorded as a sync point, which holds back the replay until it's reached again
+class InputTrace {
+private:
+	struct Record {
+		uint32 time;	// milliseconds since the main loop started
+		SDL_Event event;
+	};
+
+	static constexpr char signature[] = "VRINPUT1";
+
+	std::ofstream ofh;
+	vector<Record> records;	// events left to replay
+	vector<pair<uint32, uint32>> reached;	// sync points that happened during the replay but haven't been passed yet with their time
+	sizet next = 0;
+	uint32 origin = 0;
+	uint32 windowId = 0;	// replaces the recorded window IDs if set
+	uint64 loadStart = 0;
+	vector<double> frameTimes, loadTimes;	// milliseconds
+	bool replaying;
+
+public:
+	InputTrace(const fs::path& file, bool replay);
+	~InputTrace();
+
+	void start(uint32 winId);
+	void record(const SDL_Event& event);
+	bool nextEvent(SDL_Event& event);	// get the next recorded event if it's due
+	void reach(uint32 type);			// let the replay know that an event happened which might be a sync point
+	bool waiting() const;				// whether the next recorded event is a sync point that hasn't been reached
+	void skipWait();					// give up on the awaited sync point
+	bool finished() const;
+	uint32 waitTime() const;			// until the next recorded event is due
+	void addFrame(uint64 ticks);
+	void startLoad();
+	void finishLoad();
+	bool isReplaying() const;
+
+private:
+	static bool recordable(uint32 type);
+	static bool syncPoint(uint32 type);
+	static void logTimes(const char* name, vector<double>& times);
+};
+
+inline bool InputTrace::finished() const {
+	return next >= records.size();
+}
+
+inline bool InputTrace::waiting() const {
+	return !finished() && syncPoint(records[next].event.type);
+}
+
+inline bool InputTrace::isReplaying() const {
+	return replaying;
+}
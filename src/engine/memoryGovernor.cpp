@@ -0,0 +1,152 @@
+#include "memoryGovernor.h"
+#ifdef __linux__
+#include <fstream>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+MemoryGovernor::MemoryGovernor() {
+#ifdef __linux__
+	// the unified hierarchy is the only one with an empty controller list
+	std::ifstream ifs("/proc/self/cgroup");
+	for (string line; std::getline(ifs, line);)
+		if (line.compare(0, 3, "0::") == 0) {
+			std::error_code ec;
+			if (fs::path drc = fs::path(cgroupRoot) / fs::u8path(line.substr(3)).relative_path(); fs::exists(drc / "memory.current", ec))
+				cgroupDir = std::move(drc);
+			break;
+		}
+#endif
+	measure();
+	pressure = evaluate();
+	lastPoll = SDL_GetTicks();
+	logInfo("Memory limit ", PicLim::memoryString(limit, 2), ", available ", PicLim::memoryString(available, 2), ", pressure ", pressureNames[uint8(pressure)]);
+}
+
+bool MemoryGovernor::update() {
+	uint32 now = SDL_GetTicks();
+	if (!SDL_TICKS_PASSED(now, lastPoll + pollInterval))
+		return false;
+	lastPoll = now;
+	if (lowMemory && SDL_TICKS_PASSED(now, lowMemoryTime + lowMemoryHold))
+		lowMemory = false;
+	measure();
+
+	// rising pressure is acted on right away, but it has to stay lower for a while before anything is allowed to grow again
+	Pressure cur = evaluate();
+	if (cur >= pressure)
+		calm = 0;
+	else if (++calm < calmPolls)
+		return false;
+	else
+		calm = 0;
+	if (cur == pressure)
+		return false;
+
+	pressure = cur;
+	logInfo("Memory pressure ", pressureNames[uint8(pressure)], ", available ", PicLim::memoryString(available, 2), " of ", PicLim::memoryString(limit, 2));
+	return true;
+}
+
+bool MemoryGovernor::lowMemoryWarning() {
+	lowMemory = true;
+	lowMemoryTime = SDL_GetTicks();
+	calm = 0;
+	if (pressure == Pressure::critical)
+		return false;
+	pressure = Pressure::critical;
+	logInfo("Low memory warning");
+	return true;
+}
+
+// the reader gets a share of what's left that shrinks with the pressure, counting what it currently holds since that gets replaced
+PicLim MemoryGovernor::limitPictures(PicLim plim, uptrt resident) const {
+	uptrt budget = std::max((available + resident) / (uptrt(2) << uint(pressure)), uptrt(1));	// at least one picture gets loaded
+	if (plim.type == PicLim::Type::size)
+		plim.setSize(std::min(plim.getSize(), budget));
+	else if (pressure != Pressure::none) {
+		plim.type = PicLim::Type::size;
+		plim.setSize(budget);
+	}
+	return plim;
+}
+
+void MemoryGovernor::measure() {
+	limit = uptrt(SDL_GetSystemRAM()) * 1024 * 1024;
+	available = limit;
+#ifdef __linux__
+	if (uptrt avail = readField("/proc/meminfo", "MemAvailable:"))
+		available = avail * 1024;
+	if (!cgroupDir.empty()) {
+		if (uptrt cgl = cgroupLimit(); cgl < limit) {
+			// file pages that haven't been touched in a while get reclaimed before the limit is hit
+			uptrt current = readValue(cgroupDir / "memory.current");
+			uptrt inactive = readField(cgroupDir / "memory.stat", "inactive_file");
+			uptrt used = current > inactive ? current - inactive : 0;
+			limit = cgl;
+			available = std::min(available, cgl > used ? cgl - used : 0);
+		}
+		std::error_code ec;
+		if (fs::path file = cgroupDir / "memory.pressure"; fs::exists(file, ec)) {
+			readStalls(file);
+			return;
+		}
+	}
+	readStalls("/proc/pressure/memory");
+#elif defined(_WIN32)
+	MEMORYSTATUSEX status;
+	status.dwLength = sizeof(status);
+	if (GlobalMemoryStatusEx(&status)) {
+		limit = uptrt(status.ullTotalPhys);
+		available = uptrt(status.ullAvailPhys);
+	}
+#endif
+}
+
+MemoryGovernor::Pressure MemoryGovernor::evaluate() const {
+	float left = limit ? float(available) / float(limit) : 1.f;
+	if (lowMemory || left < criticalHeadroom || stallFull >= criticalStall)
+		return Pressure::critical;
+	if (left < someHeadroom || stallSome >= someStall)
+		return Pressure::some;
+	return Pressure::none;
+}
+
+#ifdef __linux__
+// a parent's limit applies to all of its children
+uptrt MemoryGovernor::cgroupLimit() const {
+	uptrt lim = UINTPTR_MAX;
+	for (fs::path drc = cgroupDir; drc != cgroupRoot && drc.has_relative_path(); drc = drc.parent_path())
+		if (uptrt val = readValue(drc / "memory.max"))	// "max" or a missing file read as 0
+			lim = std::min(lim, val);
+	return lim;
+}
+
+// the "some" line is the share of time at least one task waited for memory and "full" is when all of them did
+void MemoryGovernor::readStalls(const fs::path& file) {
+	stallSome = stallFull = 0.f;
+	std::ifstream ifs(file);
+	for (string line; std::getline(ifs, line);)
+		if (sizet pos = line.find("avg10="); pos != string::npos) {
+			float val = toNum<float>(string_view(line).substr(pos + 6));
+			if (line.compare(0, 4, "some") == 0)
+				stallSome = val;
+			else if (line.compare(0, 4, "full") == 0)
+				stallFull = val;
+		}
+}
+
+uptrt MemoryGovernor::readValue(const fs::path& file) {
+	string line;
+	std::ifstream ifs(file);
+	return std::getline(ifs, line) ? toNum<uptrt>(line) : 0;
+}
+
+uptrt MemoryGovernor::readField(const fs::path& file, string_view key) {
+	std::ifstream ifs(file);
+	for (string line; std::getline(ifs, line);)
+		if (line.length() > key.length() && line.compare(0, key.length(), key) == 0 && isSpace(line[key.length()]))
+			return toNum<uptrt>(string_view(line).substr(key.length()));
+	return 0;
+}
+#endif
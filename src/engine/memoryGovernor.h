@@ -0,0 +1,72 @@
+#pragma once
+
+#include "utils/settings.h"
+
+// keeps track of how much memory is left for the process and how much the system is struggling to provide it
+class MemoryGovernor {
+public:
+	enum class Pressure : uint8 {
+		none,
+		some,		// stop background work from growing
+		critical	// drop whatever isn't in view
+	};
+	static constexpr array<const char*, sizet(Pressure::critical) + 1> pressureNames = {
+		"none",
+		"some",
+		"critical"
+	};
+
+private:
+	static constexpr uint32 pollInterval = 1000;		// milliseconds between measurements
+	static constexpr uint32 lowMemoryHold = 10000;		// how long a low memory warning keeps the pressure critical
+	static constexpr uint calmPolls = 3;				// measurements below the current level before stepping down
+	static constexpr float someHeadroom = 0.25f;		// fractions of the limit that are still available
+	static constexpr float criticalHeadroom = 0.1f;
+	static constexpr float someStall = 10.f;			// percentage of time spent waiting for memory over the last 10 seconds
+	static constexpr float criticalStall = 5.f;			// same but for the time when every task was stalled
+#ifdef __linux__
+	static constexpr char cgroupRoot[] = "/sys/fs/cgroup";
+#endif
+
+	fs::path cgroupDir;		// empty if the process isn't in a cgroup v2 hierarchy
+	uptrt limit = 0;		// bytes the process may use at most
+	uptrt available = 0;	// bytes that can still be allocated without reclaiming
+	float stallSome = 0.f, stallFull = 0.f;
+	uint32 lastPoll = 0;
+	uint32 lowMemoryTime = 0;
+	uint calm = 0;
+	bool lowMemory = false;
+	Pressure pressure = Pressure::none;
+
+public:
+	MemoryGovernor();
+
+	bool update();	// measures again once the interval has passed and returns whether the pressure changed
+	bool lowMemoryWarning();	// returns whether the pressure changed
+	Pressure getPressure() const;
+	uptrt getLimit() const;
+	uptrt getAvailable() const;
+	PicLim limitPictures(PicLim plim, uptrt resident) const;
+
+private:
+	void measure();
+	Pressure evaluate() const;
+#ifdef __linux__
+	uptrt cgroupLimit() const;
+	void readStalls(const fs::path& file);
+	static uptrt readValue(const fs::path& file);
+	static uptrt readField(const fs::path& file, string_view key);
+#endif
+};
+
+inline MemoryGovernor::Pressure MemoryGovernor::getPressure() const {
+	return pressure;
+}
+
+inline uptrt MemoryGovernor::getLimit() const {
+	return limit;
+}
+
+inline uptrt MemoryGovernor::getAvailable() const {
+	return available;
+}
@@ -7,8 +7,33 @@ Renderer::View::View(SDL_Window* window, const Recti& area) :
 
 void Renderer::setCompression(bool) {}
 
+bool Renderer::startPartialDraw(View*, const Recti&) {
+	return false;
+}
+
 void Renderer::finishRender() {}
 
+bool Renderer::hasPendingUploads() const {
+	return false;
+}
+
+uptrt Renderer::deviceMemory() const {
+	return 0;
+}
+
+Renderer::TexStats Renderer::getTexTotals() const {
+	TexStats sum;
+	for (const TexStats& it : texStats)
+		sum += it;
+	return sum;
+}
+
+void Renderer::copyArea(SDL_Surface* dst, const SDL_Surface* src, const Recti& area) {
+	sizet bpp = src->format->BytesPerPixel;
+	for (int y = area.y; y < area.y + area.h; ++y)
+		memcpy(static_cast<uint8*>(dst->pixels) + sizet(y) * sizet(dst->pitch) + sizet(area.x) * bpp, static_cast<const uint8*>(src->pixels) + sizet(y) * sizet(src->pitch) + sizet(area.x) * bpp, sizet(area.w) * bpp);
+}
+
 SDL_Surface* Renderer::limitSize(SDL_Surface* img, uint32 limit) {
 	if (img && (uint32(img->w) > limit || uint32(img->h) > limit)) {
 		float scale = float(limit) / float(img->w > img->h ? img->w : img->h);
@@ -3,14 +3,40 @@
 #include "utils/utils.h"
 
 class Texture {
+public:
+	enum class Owner : uint8 {
+		reader,
+		preview,
+		text,
+		icon,
+		max
+	};
+	static constexpr array<const char*, sizet(Owner::max)> ownerNames = {
+		"reader",
+		"previews",
+		"text",
+		"icons"
+	};
+
 private:
 	ivec2 res;
+	uptrt cpuBytes = 0;	// kept in system memory by the renderer
+	uptrt gpuBytes = 0;	// allocated on the device
+	Owner owner = Owner::text;
+	mutable uint32 lastUse = 0;	// frame in which it was last drawn or created
 
 protected:
 	Texture(ivec2 size);
 
 public:
 	ivec2 getRes() const;
+	uptrt getCpuBytes() const;
+	uptrt getGpuBytes() const;
+	Owner getOwner() const;
+	uint32 getLastUse() const;
+
+	friend class Renderer;
+	friend class DrawSys;
 };
 
 inline Texture::Texture(ivec2 size) :
@@ -21,6 +47,22 @@ inline ivec2 Texture::getRes() const {
 	return res;
 }
 
+inline uptrt Texture::getCpuBytes() const {
+	return cpuBytes;
+}
+
+inline uptrt Texture::getGpuBytes() const {
+	return gpuBytes;
+}
+
+inline Texture::Owner Texture::getOwner() const {
+	return owner;
+}
+
+inline uint32 Texture::getLastUse() const {
+	return lastUse;
+}
+
 class Renderer {
 public:
 	static constexpr int singleDspId = -1;
@@ -34,8 +76,36 @@ public:
 
 	struct ErrorSkip {};
 
+	struct TexStats {
+		sizet count = 0;
+		uptrt pixels = 0;
+		uptrt cpuBytes = 0;
+		uptrt gpuBytes = 0;
+
+		TexStats& operator+=(const TexStats& st);
+	};
+
+	enum class GpuPass : uint8 {
+		draw,
+		select,
+		upload,
+		max
+	};
+	static constexpr array<const char*, sizet(GpuPass::max)> gpuPassNames = {
+		"draw",
+		"select",
+		"upload"
+	};
+
+	struct GpuTimes {
+		array<float, sizet(GpuPass::max)> ms{};	// of the last frame whose queries were resolved
+		bool valid = false;
+	};
+
 protected:
 	umap<int, View*> views;
+	array<TexStats, sizet(Texture::Owner::max)> texStats;
+	GpuTimes gpuTimes;
 
 public:
 	virtual ~Renderer() = default;
@@ -46,21 +116,77 @@ public:
 	virtual void setCompression(bool);
 	virtual void getAdditionalSettings(bool& compression, vector<pair<u32vec2, string>>& devices) = 0;
 	virtual void startDraw(View* view) = 0;
+	virtual bool startPartialDraw(View* view, const Recti& area);
 	virtual void drawRect(const Texture* tex, const Recti& rect, const Recti& frame, const vec4& color) = 0;
 	virtual void finishDraw(View* view) = 0;
 	virtual void finishRender();
 	virtual void startSelDraw(View* view, ivec2 pos) = 0;
 	virtual void drawSelRect(const Widget* wgt, const Recti& rect, const Recti& frame) = 0;
 	virtual Widget* finishSelDraw(View* view) = 0;
-	virtual Texture* texFromImg(SDL_Surface* img) = 0;
+	virtual Texture* texFromImg(SDL_Surface* img, Texture::Owner owner) = 0;
 	virtual Texture* texFromText(SDL_Surface* img) = 0;
+	virtual void updateText(Texture* tex, const SDL_Surface* img, const Recti& area) = 0;	// copy an area of the surface the text texture was made from
 	virtual void freeTexture(Texture* tex) = 0;
+	virtual bool hasPendingUploads() const;
+	virtual uptrt deviceMemory() const;	// bytes of memory the device has for textures or 0 if that's unknown
 
 	const umap<int, View*>& getViews() const;
+	const TexStats& getTexStats(Texture::Owner owner) const;
+	TexStats getTexTotals() const;
+	const GpuTimes& getGpuTimes() const;
 protected:
+	template <class T> T* countTexture(T* tex, Texture::Owner owner, uptrt gpuBytes, uptrt cpuBytes = 0);
+	void recountTexture(Texture* tex, uptrt gpuBytes);
+	void uncountTexture(const Texture* tex);
 	static SDL_Surface* limitSize(SDL_Surface* img, uint32 limit);
+	static void copyArea(SDL_Surface* dst, const SDL_Surface* src, const Recti& area);	// both have to be of the same format
 };
 
 inline const umap<int, Renderer::View*>& Renderer::getViews() const {
 	return views;
 }
+
+inline Renderer::TexStats& Renderer::TexStats::operator+=(const TexStats& st) {
+	count += st.count;
+	pixels += st.pixels;
+	cpuBytes += st.cpuBytes;
+	gpuBytes += st.gpuBytes;
+	return *this;
+}
+
+inline const Renderer::TexStats& Renderer::getTexStats(Texture::Owner owner) const {
+	return texStats[uint8(owner)];
+}
+
+inline const Renderer::GpuTimes& Renderer::getGpuTimes() const {
+	return gpuTimes;
+}
+
+template <class T>
+T* Renderer::countTexture(T* tex, Texture::Owner owner, uptrt gpuBytes, uptrt cpuBytes) {
+	if (tex) {
+		tex->owner = owner;
+		tex->cpuBytes = cpuBytes;
+		tex->gpuBytes = gpuBytes;
+		TexStats& st = texStats[uint8(owner)];
+		++st.count;
+		st.pixels += uptrt(tex->getRes().x) * uptrt(tex->getRes().y);
+		st.cpuBytes += cpuBytes;
+		st.gpuBytes += gpuBytes;
+	}
+	return tex;
+}
+
+inline void Renderer::recountTexture(Texture* tex, uptrt gpuBytes) {
+	TexStats& st = texStats[uint8(tex->owner)];
+	st.gpuBytes = st.gpuBytes - tex->gpuBytes + gpuBytes;
+	tex->gpuBytes = gpuBytes;
+}
+
+inline void Renderer::uncountTexture(const Texture* tex) {
+	TexStats& st = texStats[uint8(tex->owner)];
+	--st.count;
+	st.pixels -= uptrt(tex->getRes().x) * uptrt(tex->getRes().y);
+	st.cpuBytes -= tex->cpuBytes;
+	st.gpuBytes -= tex->gpuBytes;
+}
@@ -1,6 +1,7 @@
 #ifdef WITH_DIRECTX
 #include "rendererDx.h"
 #include "utils/settings.h"
+#include "utils/trace.h"
 #include <glm/gtc/type_ptr.hpp>
 #include <comdef.h>
 #include <wrl/client.h>
@@ -378,22 +379,55 @@ void RendererDx::uploadBuffer(ID3D11Buffer* buffer, const T& data) {
 	ctx->Unmap(buffer, 0);
 }
 
-Texture* RendererDx::texFromImg(SDL_Surface* img) {
-	if (auto [pic, fmt] = pickPixFormat(img); pic)
-		return createTexture(img, uvec2(pic->w, pic->h), fmt);
-	return nullptr;
+Texture* RendererDx::texFromImg(SDL_Surface* img, Texture::Owner owner) {
+	SDL_Surface* pic;
+	DXGI_FORMAT fmt;
+	{
+		Trace::Zone zone("convert");
+		std::tie(pic, fmt) = pickPixFormat(img);
+	}
+	if (!pic)
+		return nullptr;
+
+	Trace::Zone zone("upload");
+	zone.setBytes(uptrt(pic->pitch) * uptrt(pic->h));
+	TextureDx* tex = createTexture(pic, uvec2(pic->w, pic->h), fmt);
+	return tex ? countTexture(tex, owner, textureSize(tex)) : nullptr;
 }
 
 Texture* RendererDx::texFromText(SDL_Surface* img) {
-	return img ? createTexture(img, glm::min(uvec2(img->w, img->h), uvec2(D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION)), DXGI_FORMAT_B8G8R8A8_UNORM) : nullptr;
+	TextureDx* tex = img ? createTexture(img, glm::min(uvec2(img->w, img->h), uvec2(D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION)), DXGI_FORMAT_B8G8R8A8_UNORM, true) : nullptr;
+	return tex ? countTexture(tex, Texture::Owner::text, textureSize(tex)) : nullptr;
+}
+
+void RendererDx::updateText(Texture* tex, const SDL_Surface* img, const Recti& area) {
+	ComPtr<ID3D11Resource> texture;
+	static_cast<TextureDx*>(tex)->view->GetResource(&texture);
+	D3D11_BOX box = { UINT(area.x), UINT(area.y), 0, UINT(area.x + area.w), UINT(area.y + area.h), 1 };
+	ctx->UpdateSubresource(texture.Get(), 0, &box, static_cast<const uint8*>(img->pixels) + sizet(area.y) * sizet(img->pitch) + sizet(area.x) * img->format->BytesPerPixel, img->pitch, 0);
+}
+
+// D3D11 doesn't expose allocation sizes, but every format used is 4 bytes per pixel without padding
+uptrt RendererDx::textureSize(const TextureDx* tex) {
+	return uptrt(tex->getRes().x) * uptrt(tex->getRes().y) * 4;
 }
 
 void RendererDx::freeTexture(Texture* tex) {
+	uncountTexture(tex);
 	static_cast<TextureDx*>(tex)->view->Release();
 	delete tex;
 }
 
-RendererDx::TextureDx* RendererDx::createTexture(SDL_Surface* img, uvec2 res, DXGI_FORMAT format) {
+// integrated adapters only reserve a sliver of dedicated memory and use a share of the system's instead
+uptrt RendererDx::deviceMemory() const {
+	ComPtr<IDXGIDevice> dxgiDev;
+	ComPtr<IDXGIAdapter> adapter;
+	if (DXGI_ADAPTER_DESC desc; SUCCEEDED(dev->QueryInterface(__uuidof(IDXGIDevice), &dxgiDev)) && SUCCEEDED(dxgiDev->GetAdapter(&adapter)) && SUCCEEDED(adapter->GetDesc(&desc)))
+		return uptrt(desc.DedicatedVideoMemory >= minDedicatedMemory ? desc.DedicatedVideoMemory : desc.SharedSystemMemory);
+	return 0;
+}
+
+RendererDx::TextureDx* RendererDx::createTexture(SDL_Surface* img, uvec2 res, DXGI_FORMAT format, bool updatable) {
 	try {
 		D3D11_TEXTURE2D_DESC texDesc{};
 		texDesc.Width = res.x;
@@ -402,7 +436,7 @@ RendererDx::TextureDx* RendererDx::createTexture(SDL_Surface* img, uvec2 res, DX
 		texDesc.ArraySize = 1;
 		texDesc.Format = format;
 		texDesc.SampleDesc.Count = 1;
-		texDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		texDesc.Usage = updatable ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
 		texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 
 		D3D11_SUBRESOURCE_DATA subrscData{};
@@ -6,6 +6,8 @@
 
 class RendererDx : public Renderer {
 private:
+	static constexpr SIZE_T minDedicatedMemory = 512 * 1024 * 1024;	// less than this means the adapter is integrated
+
 	class TextureDx : public Texture {
 	private:
 		ID3D11ShaderResourceView* view;
@@ -78,9 +80,11 @@ public:
 	void drawSelRect(const Widget* wgt, const Recti& rect, const Recti& frame) final;
 	Widget* finishSelDraw(View* view) final;
 
-	Texture* texFromImg(SDL_Surface* img) final;
+	Texture* texFromImg(SDL_Surface* img, Texture::Owner owner) final;
 	Texture* texFromText(SDL_Surface* img) final;
+	void updateText(Texture* tex, const SDL_Surface* img, const Recti& area) final;
 	void freeTexture(Texture* tex) final;
+	uptrt deviceMemory() const final;
 
 private:
 	static IDXGIFactory* createFactory();
@@ -89,7 +93,8 @@ private:
 	void initShader();
 
 	template <class T> void uploadBuffer(ID3D11Buffer* buffer, const T& data);
-	TextureDx* createTexture(SDL_Surface* img, uvec2 res, DXGI_FORMAT format);
+	TextureDx* createTexture(SDL_Surface* img, uvec2 res, DXGI_FORMAT format, bool updatable = false);
+	static uptrt textureSize(const TextureDx* tex);
 	static pair<SDL_Surface*, DXGI_FORMAT> pickPixFormat(SDL_Surface* img);
 	static string hresultToStr(HRESULT rs);
 };
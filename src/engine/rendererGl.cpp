@@ -1,6 +1,7 @@
 #ifdef WITH_OPENGL
 #include "rendererGl.h"
 #include "utils/settings.h"
+#include "utils/trace.h"
 #include <glm/gtc/type_ptr.hpp>
 #include <regex>
 
@@ -35,11 +36,27 @@ RendererGl::RendererGl(const umap<int, SDL_Window*>& windows, const Settings* se
 	initFunctions();
 #endif
 	initShader();
+	initStreaming();
+	initTimers();
+	initMemoryInfo();
+	for (auto [id, view] : views) {
+		SDL_GL_MakeCurrent(view->win, static_cast<ViewGl*>(view)->ctx);
+		initCanvas(static_cast<ViewGl*>(view));
+	}
 	setCompression(sets->compression);
 	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexSize);
 }
 
 RendererGl::~RendererGl() {
+	for (TextureGl* it : pendingUploads)
+		glDeleteSync(it->fence);
+	if (timerSupported) {
+		for (const TimerQuery& it : timerQueries)
+			freeQueries.push_back(it.id);
+		glDeleteQueries(freeQueries.size(), freeQueries.data());
+	}
+	if (pbos[0])
+		glDeleteBuffers(pbos.size(), pbos.data());
 	glDeleteVertexArrays(1, &vao);
 	glDeleteTextures(1, &texSel);
 	glDeleteFramebuffers(1, &fboSel);
@@ -47,7 +64,11 @@ RendererGl::~RendererGl() {
 	glDeleteProgram(progGui);
 
 	for (auto [id, view] : views) {
-		SDL_GL_DeleteContext(static_cast<ViewGl*>(view)->ctx);
+		ViewGl* gvw = static_cast<ViewGl*>(view);
+		SDL_GL_MakeCurrent(gvw->win, gvw->ctx);
+		glDeleteFramebuffers(1, &gvw->fboCanvas);
+		glDeleteTextures(1, &gvw->texCanvas);
+		SDL_GL_DeleteContext(gvw->ctx);
 		delete view;
 	}
 }
@@ -89,6 +110,7 @@ void RendererGl::updateView(ivec2& viewRes) {
 		SDL_GL_GetDrawableSize(views.begin()->second->win, &viewRes.x, &viewRes.y);
 		views.begin()->second->rect.size() = viewRes;
 		glViewport(0, 0, viewRes.x, viewRes.y);
+		resizeCanvas(static_cast<ViewGl*>(views.begin()->second));
 	}
 }
 
@@ -96,28 +118,45 @@ void RendererGl::updateView(ivec2& viewRes) {
 void RendererGl::initFunctions() {
 	glActiveTexture = reinterpret_cast<decltype(glActiveTexture)>(SDL_GL_GetProcAddress("glActiveTexture"));
 	glAttachShader = reinterpret_cast<decltype(glAttachShader)>(SDL_GL_GetProcAddress("glAttachShader"));
+	glBeginQuery = reinterpret_cast<decltype(glBeginQuery)>(SDL_GL_GetProcAddress("glBeginQuery"));
+	glBindBuffer = reinterpret_cast<decltype(glBindBuffer)>(SDL_GL_GetProcAddress("glBindBuffer"));
 	glBindFramebuffer = reinterpret_cast<decltype(glBindFramebuffer)>(SDL_GL_GetProcAddress("glBindFramebuffer"));
 	glBindVertexArray = reinterpret_cast<decltype(glBindVertexArray)>(SDL_GL_GetProcAddress("glBindVertexArray"));
+	glBlitFramebuffer = reinterpret_cast<decltype(glBlitFramebuffer)>(SDL_GL_GetProcAddress("glBlitFramebuffer"));
+	glBufferData = reinterpret_cast<decltype(glBufferData)>(SDL_GL_GetProcAddress("glBufferData"));
 	glCheckFramebufferStatus = reinterpret_cast<decltype(glCheckFramebufferStatus)>(SDL_GL_GetProcAddress("glCheckFramebufferStatus"));
 	glClearBufferuiv = reinterpret_cast<decltype(glClearBufferuiv)>(SDL_GL_GetProcAddress("glClearBufferuiv"));
+	glClientWaitSync = reinterpret_cast<decltype(glClientWaitSync)>(SDL_GL_GetProcAddress("glClientWaitSync"));
 	glCompileShader = reinterpret_cast<decltype(glCompileShader)>(SDL_GL_GetProcAddress("glCompileShader"));
 	glCreateProgram = reinterpret_cast<decltype(glCreateProgram)>(SDL_GL_GetProcAddress("glCreateProgram"));
 	glCreateShader = reinterpret_cast<decltype(glCreateShader)>(SDL_GL_GetProcAddress("glCreateShader"));
+	glDeleteBuffers = reinterpret_cast<decltype(glDeleteBuffers)>(SDL_GL_GetProcAddress("glDeleteBuffers"));
 	glDeleteFramebuffers = reinterpret_cast<decltype(glDeleteFramebuffers)>(SDL_GL_GetProcAddress("glDeleteFramebuffers"));
 	glDeleteShader = reinterpret_cast<decltype(glDeleteShader)>(SDL_GL_GetProcAddress("glDeleteShader"));
+	glDeleteSync = reinterpret_cast<decltype(glDeleteSync)>(SDL_GL_GetProcAddress("glDeleteSync"));
 	glDeleteProgram = reinterpret_cast<decltype(glDeleteProgram)>(SDL_GL_GetProcAddress("glDeleteProgram"));
+	glDeleteQueries = reinterpret_cast<decltype(glDeleteQueries)>(SDL_GL_GetProcAddress("glDeleteQueries"));
 	glDeleteVertexArrays = reinterpret_cast<decltype(glDeleteVertexArrays)>(SDL_GL_GetProcAddress("glDeleteVertexArrays"));
 	glDetachShader = reinterpret_cast<decltype(glDetachShader)>(SDL_GL_GetProcAddress("glDetachShader"));
+	glEndQuery = reinterpret_cast<decltype(glEndQuery)>(SDL_GL_GetProcAddress("glEndQuery"));
+	glFenceSync = reinterpret_cast<decltype(glFenceSync)>(SDL_GL_GetProcAddress("glFenceSync"));
 	glFramebufferTexture1D = reinterpret_cast<decltype(glFramebufferTexture1D)>(SDL_GL_GetProcAddress("glFramebufferTexture1D"));
+	glFramebufferTexture2D = reinterpret_cast<decltype(glFramebufferTexture2D)>(SDL_GL_GetProcAddress("glFramebufferTexture2D"));
+	glGenBuffers = reinterpret_cast<decltype(glGenBuffers)>(SDL_GL_GetProcAddress("glGenBuffers"));
 	glGenFramebuffers = reinterpret_cast<decltype(glGenFramebuffers)>(SDL_GL_GetProcAddress("glGenFramebuffers"));
+	glGenQueries = reinterpret_cast<decltype(glGenQueries)>(SDL_GL_GetProcAddress("glGenQueries"));
 	glGenVertexArrays = reinterpret_cast<decltype(glGenVertexArrays)>(SDL_GL_GetProcAddress("glGenVertexArrays"));
 	glGetProgramInfoLog = reinterpret_cast<decltype(glGetProgramInfoLog)>(SDL_GL_GetProcAddress("glGetProgramInfoLog"));
 	glGetProgramiv = reinterpret_cast<decltype(glGetProgramiv)>(SDL_GL_GetProcAddress("glGetProgramiv"));
+	glGetQueryObjectiv = reinterpret_cast<decltype(glGetQueryObjectiv)>(SDL_GL_GetProcAddress("glGetQueryObjectiv"));
+	glGetQueryObjectui64v = reinterpret_cast<decltype(glGetQueryObjectui64v)>(SDL_GL_GetProcAddress("glGetQueryObjectui64v"));
 	glGetShaderInfoLog = reinterpret_cast<decltype(glGetShaderInfoLog)>(SDL_GL_GetProcAddress("glGetShaderInfoLog"));
 	glGetShaderiv = reinterpret_cast<decltype(glGetShaderiv)>(SDL_GL_GetProcAddress("glGetShaderiv"));
 	glGetUniformLocation = reinterpret_cast<decltype(glGetUniformLocation)>(SDL_GL_GetProcAddress("glGetUniformLocation"));
 	glLinkProgram = reinterpret_cast<decltype(glLinkProgram)>(SDL_GL_GetProcAddress("glLinkProgram"));
+	glMapBufferRange = reinterpret_cast<decltype(glMapBufferRange)>(SDL_GL_GetProcAddress("glMapBufferRange"));
 	glShaderSource = reinterpret_cast<decltype(glShaderSource)>(SDL_GL_GetProcAddress("glShaderSource"));
+	glTexStorage2D = reinterpret_cast<decltype(glTexStorage2D)>(SDL_GL_GetProcAddress("glTexStorage2D"));
 	glUniform1i = reinterpret_cast<decltype(glUniform1i)>(SDL_GL_GetProcAddress("glUniform1i"));
 	glUniform2f = reinterpret_cast<decltype(glUniform2f)>(SDL_GL_GetProcAddress("glUniform2f"));
 	glUniform2fv = reinterpret_cast<decltype(glUniform2fv)>(SDL_GL_GetProcAddress("glUniform2fv"));
@@ -126,6 +165,7 @@ void RendererGl::initFunctions() {
 	glUniform4f = reinterpret_cast<decltype(glUniform4f)>(SDL_GL_GetProcAddress("glUniform4f"));
 	glUniform4fv = reinterpret_cast<decltype(glUniform4fv)>(SDL_GL_GetProcAddress("glUniform4fv"));
 	glUniform4iv = reinterpret_cast<decltype(glUniform4iv)>(SDL_GL_GetProcAddress("glUniform4iv"));
+	glUnmapBuffer = reinterpret_cast<decltype(glUnmapBuffer)>(SDL_GL_GetProcAddress("glUnmapBuffer"));
 	glUseProgram = reinterpret_cast<decltype(glUseProgram)>(SDL_GL_GetProcAddress("glUseProgram"));
 #ifndef NDEBUG
 	int gval;
@@ -265,6 +305,128 @@ void main() {
 	glUseProgram(progGui);
 }
 
+void RendererGl::initStreaming() {
+#ifdef OPENGLES
+	syncSupported = storageSupported = true;
+#else
+	int major, minor;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	syncSupported = (major > 3 || (major == 3 && minor >= 2) || SDL_GL_ExtensionSupported("GL_ARB_sync")) && glFenceSync && glClientWaitSync && glDeleteSync;
+	storageSupported = (major > 4 || (major == 4 && minor >= 2) || SDL_GL_ExtensionSupported("GL_ARB_texture_storage")) && glTexStorage2D;
+#endif
+	if (syncSupported)
+		glGenBuffers(pbos.size(), pbos.data());
+}
+
+void RendererGl::initTimers() {
+#ifndef OPENGLES
+	// query objects aren't shared between contexts, so only a single view gets timed
+	int major, minor;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	glGetIntegerv(GL_MINOR_VERSION, &minor);
+	timerSupported = views.size() == 1 && (major > 3 || (major == 3 && minor >= 3) || SDL_GL_ExtensionSupported("GL_ARB_timer_query"))
+		&& glBeginQuery && glDeleteQueries && glEndQuery && glGenQueries && glGetQueryObjectiv && glGetQueryObjectui64v;
+#endif
+}
+
+// there's no core query for the amount of video memory, but some drivers report it in kilobytes
+void RendererGl::initMemoryInfo() {
+#ifndef OPENGLES
+	GLint kb = 0;
+	if (SDL_GL_ExtensionSupported("GL_NVX_gpu_memory_info"))
+		glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &kb);
+	else if (SDL_GL_ExtensionSupported("GL_ATI_meminfo")) {
+		// only tells what's free right now, which depends on what else is running, so it's no base for a budget
+		array<GLint, 4> info{};	// free memory, largest free block, free and largest block of auxiliary memory
+		glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, info.data());
+		logInfo("Free texture memory ", PicLim::memoryString(uptrt(std::max(info[0], 0)) * 1024));
+	}
+	vidMemory = uptrt(std::max(kb, 0)) * 1024;
+#endif
+}
+
+void RendererGl::initCanvas(ViewGl* view) {
+	glGenTextures(1, &view->texCanvas);
+	resizeCanvas(view);
+	glGenFramebuffers(1, &view->fboCanvas);
+	glBindFramebuffer(GL_FRAMEBUFFER, view->fboCanvas);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, view->texCanvas, 0);
+	checkFramebufferStatus("canvas");
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RendererGl::resizeCanvas(const ViewGl* view) {
+	glBindTexture(GL_TEXTURE_2D, view->texCanvas);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, view->rect.w, view->rect.h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+}
+
+void RendererGl::checkUploads() {
+	for (vector<TextureGl*>::iterator it = pendingUploads.begin(); it != pendingUploads.end();)
+		if (GLenum rs = glClientWaitSync((*it)->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0); rs == GL_ALREADY_SIGNALED || rs == GL_CONDITION_SATISFIED || rs == GL_WAIT_FAILED) {
+			glDeleteSync((*it)->fence);
+			(*it)->fence = nullptr;
+			if ((*it)->measure)
+				measureTexture(*it);
+			it = pendingUploads.erase(it);
+		} else
+			++it;
+}
+
+bool RendererGl::beginTimer(GpuPass pass) {
+#ifndef OPENGLES
+	if (!timerSupported || timerActive)
+		return false;
+
+	GLuint id;
+	if (!freeQueries.empty()) {
+		id = freeQueries.back();
+		freeQueries.pop_back();
+	} else
+		glGenQueries(1, &id);
+	glBeginQuery(GL_TIME_ELAPSED, id);
+	timerQueries.push_back(TimerQuery{ id, pass, timerFrame });
+	timerActive = true;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void RendererGl::endTimer() {
+#ifndef OPENGLES
+	if (timerActive) {
+		glEndQuery(GL_TIME_ELAPSED);
+		timerActive = false;
+	}
+#endif
+}
+
+void RendererGl::resolveTimers() {
+#ifndef OPENGLES
+	// queries finish in order, so a frame is done once its last query is available
+	for (vector<TimerQuery>::iterator first = timerQueries.begin(); first != timerQueries.end() && first->frame != timerFrame;) {
+		vector<TimerQuery>::iterator last = std::find_if(first, timerQueries.end(), [first](const TimerQuery& it) -> bool { return it.frame != first->frame; });
+		GLint available;
+		if (glGetQueryObjectiv(std::prev(last)->id, GL_QUERY_RESULT_AVAILABLE, &available); !available)
+			break;
+
+		gpuTimes = GpuTimes();
+		gpuTimes.valid = true;
+		for (; first != last; ++first) {
+			GLuint64 ns;
+			glGetQueryObjectui64v(first->id, GL_QUERY_RESULT, &ns);
+			gpuTimes.ms[uint8(first->pass)] += float(ns) / 1'000'000.f;
+			freeQueries.push_back(first->id);
+		}
+		first = timerQueries.erase(timerQueries.begin(), last);
+	}
+#endif
+}
+
 GLuint RendererGl::createShader(const char* vertSrc, const char* fragSrc, const char* name) const {
 #ifdef OPENGLES
 	array<pair<std::regex, const char*>, 2> replacers = {
@@ -347,12 +509,31 @@ void RendererGl::checkFramebufferStatus(const char* name) {
 }
 
 void RendererGl::startDraw(View* view) {
-	SDL_GL_MakeCurrent(view->win, static_cast<ViewGl*>(view)->ctx);
-	glUniform4f(uniPviewGui, float(view->rect.x), float(view->rect.y), float(view->rect.w) / 2.f, float(view->rect.h) / 2.f);
+	bindCanvas(view);
+	if (!pendingUploads.empty())
+		checkUploads();
+	beginTimer(GpuPass::draw);
 	glClear(GL_COLOR_BUFFER_BIT);
 }
 
+bool RendererGl::startPartialDraw(View* view, const Recti& area) {
+	bindCanvas(view);
+	beginTimer(GpuPass::draw);
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(area.x - view->rect.x, view->rect.end().y - area.end().y, area.w, area.h);
+	glClear(GL_COLOR_BUFFER_BIT);
+	return true;
+}
+
+void RendererGl::bindCanvas(const View* view) {
+	SDL_GL_MakeCurrent(view->win, static_cast<const ViewGl*>(view)->ctx);
+	glBindFramebuffer(GL_FRAMEBUFFER, static_cast<const ViewGl*>(view)->fboCanvas);
+	glUniform4f(uniPviewGui, float(view->rect.x), float(view->rect.y), float(view->rect.w) / 2.f, float(view->rect.h) / 2.f);
+}
+
 void RendererGl::drawRect(const Texture* tex, const Recti& rect, const Recti& frame, const vec4& color) {
+	if (static_cast<const TextureGl*>(tex)->fence)
+		return;
 	glBindTexture(GL_TEXTURE_2D, static_cast<const TextureGl*>(tex)->id);
 	glUniform4iv(uniRectGui, 1, reinterpret_cast<const int*>(&rect));
 	glUniform4iv(uniFrameGui, 1, reinterpret_cast<const int*>(&frame));
@@ -361,9 +542,24 @@ void RendererGl::drawRect(const Texture* tex, const Recti& rect, const Recti& fr
 }
 
 void RendererGl::finishDraw(View* view) {
+	glDisable(GL_SCISSOR_TEST);
+	glScissor(0, 0, 1, 1);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<ViewGl*>(view)->fboCanvas);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	// the back buffer's contents are undefined after a swap and SDL doesn't expose the buffer age, so the whole canvas has to be copied
+	glBlitFramebuffer(0, 0, view->rect.w, view->rect.h, 0, 0, view->rect.w, view->rect.h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	endTimer();
 	SDL_GL_SwapWindow(static_cast<ViewGl*>(view)->win);
 }
 
+void RendererGl::finishRender() {
+	if (timerSupported) {
+		++timerFrame;
+		resolveTimers();
+	}
+}
+
 void RendererGl::startSelDraw(View* view, ivec2 pos) {
 	uint zero[4] = { 0, 0, 0, 0 };
 	SDL_GL_MakeCurrent(view->win, static_cast<ViewGl*>(view)->ctx);
@@ -374,6 +570,7 @@ void RendererGl::startSelDraw(View* view, ivec2 pos) {
 	glUseProgram(progSel);
 	glUniform4f(uniPviewSel, float(view->rect.x), float(view->rect.y), float(view->rect.w) / 2.f, float(view->rect.h) / 2.f);
 	glBindFramebuffer(GL_FRAMEBUFFER, fboSel);
+	beginTimer(GpuPass::select);
 	glClearBufferuiv(GL_COLOR, 0, zero);
 }
 
@@ -386,6 +583,7 @@ void RendererGl::drawSelRect(const Widget* wgt, const Recti& rect, const Recti&
 
 Widget* RendererGl::finishSelDraw(View* view) {
 	uvec2 val;
+	endTimer();
 	glReadPixels(0, 0, 1, 1, GL_RG_INTEGER, GL_UNSIGNED_INT, glm::value_ptr(val));
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	glViewport(0, 0, view->rect.w, view->rect.h);
@@ -396,22 +594,66 @@ Widget* RendererGl::finishSelDraw(View* view) {
 	return reinterpret_cast<Widget*>(uptrt(val.x) | (uptrt(val.y) << 32));
 }
 
-Texture* RendererGl::texFromImg(SDL_Surface* img) {
-	if (auto [pic, pfmt, ifmt] = pickPixFormat(img); pic)
-		return createTexture(pic, ivec2(pic->w, pic->h), ifmt, pfmt, GL_LINEAR);
-	return nullptr;
+Texture* RendererGl::texFromImg(SDL_Surface* img, Texture::Owner owner) {
+	SDL_Surface* pic;
+	GLenum pfmt;
+	GLint ifmt;
+	{
+		Trace::Zone zone("convert");
+		std::tie(pic, pfmt, ifmt) = pickPixFormat(img);
+	}
+	if (!pic)
+		return nullptr;
+
+	Trace::Zone zone("upload");
+	zone.setBytes(uptrt(pic->pitch) * uptrt(pic->h));
+	ivec2 res(pic->w, pic->h);
+	TextureGl* tex = countTexture(createTexture(pic, res, ifmt, pfmt, GL_LINEAR, true), owner, uptrt(res.x) * uptrt(res.y) * 4);
+	if (ifmt != GL_RGBA8 && ifmt != GL_RGB8) {
+		tex->measure = true;
+		if (!tex->fence)
+			measureTexture(tex);
+	}
+	return tex;
 }
 
 Texture* RendererGl::texFromText(SDL_Surface* img) {
-	return img ? createTexture(img, glm::min(ivec2(img->w, img->h), ivec2(maxTexSize)), GL_RGBA8, textPixFormat, GL_NEAREST) : nullptr;
+	if (!img)
+		return nullptr;
+	ivec2 res = glm::min(ivec2(img->w, img->h), ivec2(maxTexSize));
+	return countTexture(createTexture(img, res, GL_RGBA8, textPixFormat, GL_NEAREST, false), Texture::Owner::text, uptrt(res.x) * uptrt(res.y) * 4);
+}
+
+void RendererGl::updateText(Texture* tex, const SDL_Surface* img, const Recti& area) {
+	glBindTexture(GL_TEXTURE_2D, static_cast<TextureGl*>(tex)->id);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, img->pitch / img->format->BytesPerPixel);
+	bool timed = beginTimer(GpuPass::upload);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, area.x, area.y, area.w, area.h, textPixFormat, GL_UNSIGNED_BYTE, static_cast<const uint8*>(img->pixels) + sizet(area.y) * sizet(img->pitch) + sizet(area.x) * img->format->BytesPerPixel);
+	if (timed)
+		endTimer();
 }
 
 void RendererGl::freeTexture(Texture* tex) {
-	glDeleteTextures(1, &static_cast<TextureGl*>(tex)->id);
-	delete tex;
+	TextureGl* gtx = static_cast<TextureGl*>(tex);
+	uncountTexture(gtx);
+	if (gtx->fence) {
+		glDeleteSync(gtx->fence);
+		pendingUploads.erase(std::find(pendingUploads.begin(), pendingUploads.end(), gtx));
+	}
+	glDeleteTextures(1, &gtx->id);
+	delete gtx;
 }
 
-RendererGl::TextureGl* RendererGl::createTexture(SDL_Surface* img, ivec2 res, GLint iform, GLenum pform, GLint filter) {
+bool RendererGl::hasPendingUploads() const {
+	return !pendingUploads.empty();
+}
+
+uptrt RendererGl::deviceMemory() const {
+	return vidMemory;
+}
+
+// text has to be drawable right away, since a page of glyphs is shared by every label
+RendererGl::TextureGl* RendererGl::createTexture(SDL_Surface* img, ivec2 res, GLint iform, GLenum pform, GLint filter, bool stream) {
 	GLuint id;
 	glGenTextures(1, &id);
 	glBindTexture(GL_TEXTURE_2D, id);
@@ -421,9 +663,52 @@ RendererGl::TextureGl* RendererGl::createTexture(SDL_Surface* img, ivec2 res, GL
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
 	glPixelStorei(GL_UNPACK_ROW_LENGTH, img->pitch / img->format->BytesPerPixel);
-	glTexImage2D(GL_TEXTURE_2D, 0, iform, res.x, res.y, 0, pform, GL_UNSIGNED_BYTE, img->pixels);
+
+	bool timed = beginTimer(GpuPass::upload);
+	TextureGl* tex = new TextureGl(res, id);
+	if (sizet size = sizet(img->pitch) * sizet(res.y); stream && syncSupported && size >= streamThreshold) {
+		if (storageSupported && (iform == GL_RGBA8 || iform == GL_RGB8))	// generic compressed formats can't be immutable
+			glTexStorage2D(GL_TEXTURE_2D, 1, iform, res.x, res.y);
+		else
+			glTexImage2D(GL_TEXTURE_2D, 0, iform, res.x, res.y, 0, pform, GL_UNSIGNED_BYTE, nullptr);
+
+		// orphan the next buffer of the ring so the copy doesn't have to wait for a previous upload from it
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[pboIndex]);
+		pboIndex = (pboIndex + 1) % pbos.size();
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		bool mapped = false;
+		if (void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)) {
+			memcpy(dst, img->pixels, size);
+			mapped = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+		if (mapped) {
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, res.x, res.y, pform, GL_UNSIGNED_BYTE, nullptr);
+			tex->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			pendingUploads.push_back(tex);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if (!mapped)
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, res.x, res.y, pform, GL_UNSIGNED_BYTE, img->pixels);
+	} else
+		glTexImage2D(GL_TEXTURE_2D, 0, iform, res.x, res.y, 0, pform, GL_UNSIGNED_BYTE, img->pixels);
+	if (timed)
+		endTimer();
 	SDL_FreeSurface(img);
-	return new TextureGl(res, id);
+	return tex;
+}
+
+// the driver picks the format of generic compressed textures, so their size is only known once the upload is done
+void RendererGl::measureTexture(TextureGl* tex) {
+#ifndef OPENGLES
+	GLint compressed = GL_FALSE;
+	glBindTexture(GL_TEXTURE_2D, tex->id);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &compressed);
+	if (GLint size = 0; compressed) {
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+		recountTexture(tex, uptrt(size));
+	}
+#endif
+	tex->measure = false;
 }
 
 tuple<SDL_Surface*, GLenum, GLint> RendererGl::pickPixFormat(SDL_Surface* img) const {
@@ -21,9 +21,14 @@ private:
 	static constexpr GLenum addrTargetType = GL_TEXTURE_1D;
 #endif
 
+	static constexpr uint pboCount = 4;
+	static constexpr sizet streamThreshold = 256 * 1024;	// smaller textures are uploaded directly
+
 	class TextureGl : public Texture {
 	private:
 		GLuint id = 0;
+		GLsync fence = nullptr;	// pending upload, the texture isn't drawn until it's signaled
+		bool measure = false;	// the size of a compressed texture still needs to be queried
 
 		TextureGl(ivec2 size, GLuint tex);
 
@@ -32,44 +37,79 @@ private:
 
 	struct ViewGl : View {
 		SDL_GLContext ctx;
+		GLuint fboCanvas = 0, texCanvas = 0;	// retains the last frame for partial redraws
 
 		ViewGl(SDL_Window* window, const Recti& area, SDL_GLContext context);
 	};
 
+	struct TimerQuery {
+		GLuint id;
+		GpuPass pass;
+		uint frame;
+	};
+
 	GLint uniPviewGui, uniRectGui, uniFrameGui, uniColorGui;
 	GLint uniPviewSel, uniRectSel, uniFrameSel, uniAddrSel;
 	GLuint progGui = 0, progSel = 0;
 	GLuint fboSel = 0, texSel = 0;
 	GLuint vao = 0;
+	array<GLuint, pboCount> pbos{};
+	uint pboIndex = 0;
+	vector<TextureGl*> pendingUploads;
+	vector<TimerQuery> timerQueries;	// pending in the order they were issued
+	vector<GLuint> freeQueries;
+	uint timerFrame = 0;
 	GLint iformRgb;
 	GLint iformRgba;
 	int maxTexSize;
+	uptrt vidMemory = 0;	// total dedicated memory reported by a vendor extension
+	bool syncSupported = false;
+	bool storageSupported = false;
+	bool timerSupported = false;
+	bool timerActive = false;	// only one time elapsed query can run at a time
 
 #ifndef OPENGLES
 	void (APIENTRY* glActiveTexture)(GLenum texture);
 	void (APIENTRY* glAttachShader)(GLuint program, GLuint shader);
+	void (APIENTRY* glBeginQuery)(GLenum target, GLuint id);
+	void (APIENTRY* glBindBuffer)(GLenum target, GLuint buffer);
 	void (APIENTRY* glBindFramebuffer)(GLenum target, GLuint framebuffer);
 	void (APIENTRY* glBindVertexArray)(GLuint array);
+	void (APIENTRY* glBlitFramebuffer)(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+	void (APIENTRY* glBufferData)(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
 	GLenum (APIENTRY* glCheckFramebufferStatus)(GLenum target);
 	void (APIENTRY* glClearBufferuiv)(GLenum buffer, GLint drawbuffer, const GLuint* value);
+	GLenum (APIENTRY* glClientWaitSync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
 	void (APIENTRY* glCompileShader)(GLuint shader);
 	GLuint (APIENTRY* glCreateProgram)();
 	GLuint (APIENTRY* glCreateShader)(GLenum shaderType);
+	void (APIENTRY* glDeleteBuffers)(GLsizei n, const GLuint* buffers);
 	void (APIENTRY* glDeleteFramebuffers)(GLsizei n, GLuint* framebuffers);
 	void (APIENTRY* glDeleteShader)(GLuint shader);
+	void (APIENTRY* glDeleteSync)(GLsync sync);
 	void (APIENTRY* glDeleteProgram)(GLuint program);
+	void (APIENTRY* glDeleteQueries)(GLsizei n, const GLuint* ids);
 	void (APIENTRY* glDeleteVertexArrays)(GLsizei n, const GLuint* arrays);
 	void (APIENTRY* glDetachShader)(GLuint program, GLuint shader);
+	void (APIENTRY* glEndQuery)(GLenum target);
+	GLsync (APIENTRY* glFenceSync)(GLenum condition, GLbitfield flags);
 	void (APIENTRY* glFramebufferTexture1D)(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+	void (APIENTRY* glFramebufferTexture2D)(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+	void (APIENTRY* glGenBuffers)(GLsizei n, GLuint* buffers);
 	void (APIENTRY* glGenFramebuffers)(GLsizei n, GLuint* ids);
+	void (APIENTRY* glGenQueries)(GLsizei n, GLuint* ids);
 	void (APIENTRY* glGenVertexArrays)(GLsizei n, GLuint* arrays);
 	void (APIENTRY* glGetProgramInfoLog)(GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
 	void (APIENTRY* glGetProgramiv)(GLuint program, GLenum pname, GLint* params);
+	void (APIENTRY* glGetQueryObjectiv)(GLuint id, GLenum pname, GLint* params);
+	void (APIENTRY* glGetQueryObjectui64v)(GLuint id, GLenum pname, GLuint64* params);
 	void (APIENTRY* glGetShaderInfoLog)(GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
 	void (APIENTRY* glGetShaderiv)(GLuint shader, GLenum pname, GLint* params);
 	GLint (APIENTRY* glGetUniformLocation)(GLuint program, const GLchar* name);
 	void (APIENTRY* glLinkProgram)(GLuint program);
+	void* (APIENTRY* glMapBufferRange)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
 	void (APIENTRY* glShaderSource)(GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+	void (APIENTRY* glTexStorage2D)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
 	void (APIENTRY* glUniform1i)(GLint location, GLint v0);
 	void (APIENTRY* glUniform2f)(GLint location, GLfloat v0, GLfloat v1);
 	void (APIENTRY* glUniform2fv)(GLint location, GLsizei count, const GLfloat* value);
@@ -78,6 +118,7 @@ private:
 	void (APIENTRY* glUniform4f)(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
 	void (APIENTRY* glUniform4fv)(GLint location, GLsizei count, const GLfloat* value);
 	void (APIENTRY* glUniform4iv)(GLint location, GLsizei count, const GLint* value);
+	GLboolean (APIENTRY* glUnmapBuffer)(GLenum target);
 	void (APIENTRY* glUseProgram)(GLuint program);
 #endif
 public:
@@ -91,16 +132,21 @@ public:
 	void getAdditionalSettings(bool& compression, vector<pair<u32vec2, string>>& devices) final;
 
 	void startDraw(View* view) final;
+	bool startPartialDraw(View* view, const Recti& area) final;
 	void drawRect(const Texture* tex, const Recti& rect, const Recti& frame, const vec4& color) final;
 	void finishDraw(View* view) final;
+	void finishRender() final;
 
 	void startSelDraw(View* view, ivec2 pos) final;
 	void drawSelRect(const Widget* wgt, const Recti& rect, const Recti& frame) final;
 	Widget* finishSelDraw(View* view) final;
 
-	Texture* texFromImg(SDL_Surface* img) final;
+	Texture* texFromImg(SDL_Surface* img, Texture::Owner owner) final;
 	Texture* texFromText(SDL_Surface* img) final;
+	void updateText(Texture* tex, const SDL_Surface* img, const Recti& area) final;
 	void freeTexture(Texture* tex) final;
+	bool hasPendingUploads() const final;
+	uptrt deviceMemory() const final;
 
 private:
 	void initGl(ivec2 res, bool vsync, const vec4& bgcolor);
@@ -109,11 +155,22 @@ private:
 	void initFunctions();
 #endif
 	void initShader();
+	void initStreaming();
+	void initTimers();
+	void initMemoryInfo();
+	void initCanvas(ViewGl* view);
+	void resizeCanvas(const ViewGl* view);
+	void bindCanvas(const View* view);
+	void checkUploads();
+	bool beginTimer(GpuPass pass);
+	void endTimer();
+	void resolveTimers();
 	GLuint createShader(const char* vertSrc, const char* fragSrc, const char* name) const;
 	void checkFramebufferStatus(const char* name);
 
 	template <class C, class I> static void checkStatus(GLuint id, GLenum stat, C check, I info, const string& name);
-	static TextureGl* createTexture(SDL_Surface* img, ivec2 res, GLint iform, GLenum pform, GLint filter);
+	TextureGl* createTexture(SDL_Surface* img, ivec2 res, GLint iform, GLenum pform, GLint filter, bool stream);
+	void measureTexture(TextureGl* tex);
 	tuple<SDL_Surface*, GLenum, GLint> pickPixFormat(SDL_Surface* img) const;
 #ifndef OPENGLES
 #ifndef NDEBUG
@@ -0,0 +1,122 @@
+#include "rendererNull.h"
+#include "utils/settings.h"
+
+RendererNull::TextureNull::TextureNull(SDL_Surface* surface) :
+	Texture(ivec2(surface->w, surface->h)),
+	img(surface)
+{}
+
+RendererNull::RendererNull(const umap<int, SDL_Window*>& windows, const Settings* sets, ivec2& viewRes, ivec2 origin) {
+	if (windows.size() == 1 && windows.begin()->first == singleDspId) {
+		SDL_GetWindowSize(windows.begin()->second, &viewRes.x, &viewRes.y);
+		views.emplace(singleDspId, new View(windows.begin()->second, Recti(ivec2(0), viewRes)));
+	} else {
+		views.reserve(windows.size());
+		for (auto [id, win] : windows) {
+			Recti wrect = sets->displays.at(id).translate(-origin);
+			SDL_GetWindowSize(win, &wrect.w, &wrect.h);
+			views.emplace(id, new View(win, wrect));
+			viewRes = glm::max(viewRes, wrect.end());
+		}
+	}
+}
+
+RendererNull::~RendererNull() {
+	for (auto [id, view] : views)
+		delete view;
+}
+
+void RendererNull::setClearColor(const vec4&) {}
+
+void RendererNull::setVsync(bool) {}
+
+void RendererNull::updateView(ivec2& viewRes) {
+	if (views.size() == 1) {
+		SDL_GetWindowSize(views.begin()->second->win, &viewRes.x, &viewRes.y);
+		views.begin()->second->rect.size() = viewRes;
+	}
+}
+
+void RendererNull::getAdditionalSettings(bool& compression, vector<pair<u32vec2, string>>& devices) {
+	compression = false;
+	devices.clear();
+}
+
+void RendererNull::startDraw(View* view) {
+	beginFrame(view, view->rect);
+}
+
+bool RendererNull::startPartialDraw(View* view, const Recti& area) {
+	beginFrame(view, area);
+	return true;
+}
+
+void RendererNull::beginFrame(const View* view, const Recti& area) {
+	if (!frameStarted) {
+		commands.clear();
+		frameStarted = true;
+	}
+	drawArea = area.intersect(view->rect);
+	stats.pixelsCleared += uint64(drawArea.w) * uint64(drawArea.h);
+}
+
+void RendererNull::drawRect(const Texture* tex, const Recti& rect, const Recti& frame, const vec4& color) {
+	commands.push_back(Command{ tex, nullptr, rect, frame, color });
+	++stats.drawCalls;
+	if (Recti vis = rect.intersect(frame).intersect(drawArea); !vis.empty())
+		stats.pixelsDrawn += uint64(vis.w) * uint64(vis.h);
+}
+
+void RendererNull::finishDraw(View*) {}
+
+void RendererNull::finishRender() {
+	frameStarted = false;
+	++stats.frames;
+}
+
+void RendererNull::startSelDraw(View* view, ivec2 pos) {
+	selPos = pos + view->rect.pos();
+	selected = nullptr;
+}
+
+void RendererNull::drawSelRect(const Widget* wgt, const Recti& rect, const Recti& frame) {
+	commands.push_back(Command{ nullptr, wgt, rect, frame, vec4(0.f) });
+	++stats.selCalls;
+	if (rect.intersect(frame).contains(selPos))
+		selected = wgt;	// later rects are drawn over earlier ones
+}
+
+Widget* RendererNull::finishSelDraw(View*) {
+	return const_cast<Widget*>(selected);
+}
+
+Texture* RendererNull::texFromImg(SDL_Surface* img, Texture::Owner owner) {
+	return createTexture(limitSize(img, maxTexSize), owner);
+}
+
+Texture* RendererNull::texFromText(SDL_Surface* img) {
+	return createTexture(img, Texture::Owner::text);
+}
+
+void RendererNull::updateText(Texture* tex, const SDL_Surface* img, const Recti& area) {
+	copyArea(static_cast<TextureNull*>(tex)->img, img, area);
+	stats.uploadBytes += uint64(area.w) * uint64(area.h) * img->format->BytesPerPixel;
+}
+
+void RendererNull::freeTexture(Texture* tex) {
+	TextureNull* ntx = static_cast<TextureNull*>(tex);
+	uncountTexture(ntx);
+	SDL_FreeSurface(ntx->img);
+	delete ntx;
+}
+
+RendererNull::TextureNull* RendererNull::createTexture(SDL_Surface* img, Texture::Owner owner) {
+	if (!img)
+		return nullptr;
+	stats.uploadBytes += uint64(img->pitch) * uint64(img->h);
+	return countTexture(new TextureNull(img), owner, 0, uptrt(img->pitch) * uptrt(img->h));
+}
+
+void RendererNull::resetStats() {
+	stats = Stats();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "renderer.h"
+
+// renderer without any output that keeps textures in memory and records draw calls for tests and benchmarks
+class RendererNull : public Renderer {
+public:
+	static constexpr uint32 maxTexSize = 16384;	// mimic a common GPU limit
+
+	struct Command {
+		const Texture* tex;		// null for selection rects
+		const Widget* wgt;		// null for regular draws
+		Recti rect, frame;
+		vec4 color;
+	};
+
+	struct Stats {
+		uint64 drawCalls = 0;
+		uint64 selCalls = 0;
+		uint64 uploadBytes = 0;
+		uint64 pixelsDrawn = 0;		// clipped area of all draw calls
+		uint64 pixelsCleared = 0;	// area of all started views
+		uint frames = 0;
+
+		float overdraw() const;
+	};
+
+	class TextureNull : public Texture {
+	private:
+		SDL_Surface* img;
+
+		TextureNull(SDL_Surface* surface);
+
+	public:
+		const SDL_Surface* getSurface() const;
+
+		friend class RendererNull;
+	};
+
+private:
+	vector<Command> commands;
+	Stats stats;
+	Recti drawArea;
+	ivec2 selPos;
+	const Widget* selected = nullptr;
+	bool frameStarted = false;
+
+public:
+	RendererNull(const umap<int, SDL_Window*>& windows, const Settings* sets, ivec2& viewRes, ivec2 origin);
+	~RendererNull() final;
+
+	void setClearColor(const vec4& color) final;
+	void setVsync(bool vsync) final;
+	void updateView(ivec2& viewRes) final;
+	void getAdditionalSettings(bool& compression, vector<pair<u32vec2, string>>& devices) final;
+
+	void startDraw(View* view) final;
+	bool startPartialDraw(View* view, const Recti& area) final;
+	void drawRect(const Texture* tex, const Recti& rect, const Recti& frame, const vec4& color) final;
+	void finishDraw(View* view) final;
+	void finishRender() final;
+
+	void startSelDraw(View* view, ivec2 pos) final;
+	void drawSelRect(const Widget* wgt, const Recti& rect, const Recti& frame) final;
+	Widget* finishSelDraw(View* view) final;
+
+	Texture* texFromImg(SDL_Surface* img, Texture::Owner owner) final;
+	Texture* texFromText(SDL_Surface* img) final;
+	void updateText(Texture* tex, const SDL_Surface* img, const Recti& area) final;
+	void freeTexture(Texture* tex) final;
+
+	const vector<Command>& getCommands() const;	// commands of the last or current frame
+	const Stats& getStats() const;
+	void resetStats();
+
+private:
+	void beginFrame(const View* view, const Recti& area);
+	TextureNull* createTexture(SDL_Surface* img, Texture::Owner owner);
+};
+
+inline float RendererNull::Stats::overdraw() const {
+	return pixelsCleared ? float(pixelsDrawn) / float(pixelsCleared) : 0.f;
+}
+
+inline const SDL_Surface* RendererNull::TextureNull::getSurface() const {
+	return img;
+}
+
+inline const vector<RendererNull::Command>& RendererNull::getCommands() const {
+	return commands;
+}
+
+inline const RendererNull::Stats& RendererNull::getStats() const {
+	return stats;
+}
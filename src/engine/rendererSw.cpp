@@ -0,0 +1,373 @@
+#include "rendererSw.h"
+#include "utils/settings.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SW_SSE2
+#endif
+
+// pixels are ARGB8888 and color multipliers are 0 - 256, so x * c >> 8 stays within a byte
+
+static inline uint32 lerpPixel(uint32 a, uint32 b, uint w) {
+	uint32 rb = (((a & 0xFF00FF) * (256 - w) + (b & 0xFF00FF) * w) >> 8) & 0xFF00FF;
+	uint32 ag = (((a >> 8) & 0xFF00FF) * (256 - w) + ((b >> 8) & 0xFF00FF) * w) & 0xFF00FF00;
+	return rb | ag;
+}
+
+static inline uint32 blendPixel(uint32 dst, uint32 src, const u16vec4& color) {
+	uint b = (src & 0xFF) * color[0] >> 8;
+	uint g = (src >> 8 & 0xFF) * color[1] >> 8;
+	uint r = (src >> 16 & 0xFF) * color[2] >> 8;
+	uint a = (src >> 24) * color[3] >> 8;
+	a += a >> 7;
+	uint ia = 256 - a;
+	b = (b * a + (dst & 0xFF) * ia) >> 8;
+	g = (g * a + (dst >> 8 & 0xFF) * ia) >> 8;
+	r = (r * a + (dst >> 16 & 0xFF) * ia) >> 8;
+	return 0xFF000000 | r << 16 | g << 8 | b;
+}
+
+#ifdef SW_SSE2
+static inline __m128i blendPair(__m128i src, __m128i dst, __m128i cmul, __m128i full) {
+	src = _mm_srli_epi16(_mm_mullo_epi16(src, cmul), 8);
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xFF), 0xFF);
+	a = _mm_add_epi16(a, _mm_srli_epi16(a, 7));
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, a), _mm_mullo_epi16(dst, _mm_sub_epi16(full, a))), 8);
+}
+#endif
+
+RendererSw::TextureSw::TextureSw(SDL_Surface* surface, bool filter, bool noAlpha) :
+	Texture(ivec2(surface->w, surface->h)),
+	img(surface),
+	linear(filter),
+	opaque(noAlpha)
+{}
+
+RendererSw::RendererSw(const umap<int, SDL_Window*>& windows, const Settings* sets, ivec2& viewRes, ivec2 origin, const vec4& bgcolor) :
+	clearColor(packColor(bgcolor))
+{
+	if (windows.size() == 1 && windows.begin()->first == singleDspId) {
+		SDL_GetWindowSize(windows.begin()->second, &viewRes.x, &viewRes.y);
+		views.emplace(singleDspId, new ViewSw(windows.begin()->second, Recti(ivec2(0), viewRes)));
+	} else {
+		views.reserve(windows.size());
+		for (auto [id, win] : windows) {
+			Recti wrect = sets->displays.at(id).translate(-origin);
+			SDL_GetWindowSize(win, &wrect.w, &wrect.h);
+			views.emplace(id, new ViewSw(win, wrect));
+			viewRes = glm::max(viewRes, wrect.end());
+		}
+	}
+	for (auto [id, view] : views)
+		if (!SDL_GetWindowSurface(view->win))
+			throw std::runtime_error("Failed to get window surface:"s + linend + SDL_GetError());
+
+	uint hwThreads = std::thread::hardware_concurrency();
+	workers.resize(hwThreads > 1 ? std::min(hwThreads - 1, maxWorkers) : 0);
+	for (std::thread& it : workers)
+		it = std::thread(&RendererSw::workerThread, this);
+}
+
+RendererSw::~RendererSw() {
+	{
+		std::lock_guard lock(tileLock);
+		stopping = true;
+	}
+	tileWake.notify_all();
+	for (std::thread& it : workers)
+		it.join();
+
+	for (auto [id, view] : views) {
+		SDL_FreeSurface(static_cast<ViewSw*>(view)->canvas);
+		delete view;
+	}
+}
+
+void RendererSw::setClearColor(const vec4& color) {
+	clearColor = packColor(color);
+}
+
+void RendererSw::setVsync(bool) {}
+
+void RendererSw::updateView(ivec2& viewRes) {
+	if (views.size() == 1) {
+		SDL_GetWindowSize(views.begin()->second->win, &viewRes.x, &viewRes.y);
+		views.begin()->second->rect.size() = viewRes;
+	}
+}
+
+void RendererSw::getAdditionalSettings(bool& compression, vector<pair<u32vec2, string>>& devices) {
+	compression = false;
+	devices.clear();
+}
+
+void RendererSw::startDraw(View* view) {
+	beginFrame(view, Recti(ivec2(0), view->rect.size()));
+}
+
+bool RendererSw::startPartialDraw(View* view, const Recti& area) {
+	beginFrame(view, area.translate(-view->rect.pos()));
+	return true;
+}
+
+void RendererSw::beginFrame(View* view, const Recti& area) {
+	SDL_Surface* wsf = SDL_GetWindowSurface(view->win);
+	if (!wsf)
+		throw std::runtime_error("Failed to get window surface:"s + linend + SDL_GetError());
+
+	curView = static_cast<ViewSw*>(view);
+	if (wsf->format->format == SDL_PIXELFORMAT_ARGB8888 || wsf->format->format == SDL_PIXELFORMAT_RGB888)
+		target = wsf;
+	else {
+		if (!curView->canvas || curView->canvas->w != wsf->w || curView->canvas->h != wsf->h) {
+			SDL_FreeSurface(curView->canvas);
+			if (curView->canvas = SDL_CreateRGBSurfaceWithFormat(0, wsf->w, wsf->h, 32, SDL_PIXELFORMAT_ARGB8888); !curView->canvas)
+				throw std::runtime_error("Failed to create canvas:"s + linend + SDL_GetError());
+		}
+		target = curView->canvas;
+	}
+	drawArea = area.intersect(Recti(0, 0, target->w, target->h));
+	commands.clear();
+}
+
+void RendererSw::drawRect(const Texture* tex, const Recti& rect, const Recti& frame, const vec4& color) {
+	Recti vrect = rect.translate(-curView->rect.pos());
+	if (Recti dst = vrect.intersect(frame.translate(-curView->rect.pos())).intersect(drawArea); tex && !dst.empty() && color.a > 0.f)
+		commands.push_back(Command{ static_cast<const TextureSw*>(tex), vrect, dst, u16vec4(glm::clamp(vec4(color.b, color.g, color.r, color.a) * 256.f + 0.5f, 0.f, 256.f)) });
+}
+
+void RendererSw::finishDraw(View* view) {
+	if (!drawArea.empty()) {
+		if (SDL_MUSTLOCK(target))
+			SDL_LockSurface(target);
+		{
+			std::lock_guard lock(tileLock);
+			tileNext = 0;
+			tileCount = (drawArea.h + tileHeight - 1) / tileHeight;
+			tilesDone = 0;
+		}
+		tileWake.notify_all();
+
+		vector<uint32> row;
+		renderTiles(row);
+		std::unique_lock lock(tileLock);
+		tileDone.wait(lock, [this]() -> bool { return tilesDone == tileCount; });
+		tileCount = 0;
+		lock.unlock();
+		if (SDL_MUSTLOCK(target))
+			SDL_UnlockSurface(target);
+	}
+
+	SDL_Rect area = { drawArea.x, drawArea.y, drawArea.w, drawArea.h };
+	if (target == static_cast<ViewSw*>(view)->canvas)
+		SDL_BlitSurface(target, &area, SDL_GetWindowSurface(view->win), &area);
+	SDL_UpdateWindowSurfaceRects(view->win, &area, 1);
+	commands.clear();
+}
+
+void RendererSw::workerThread() {
+	vector<uint32> row;
+	for (std::unique_lock lock(tileLock);;) {
+		tileWake.wait(lock, [this]() -> bool { return stopping || tileNext < tileCount; });
+		if (stopping)
+			break;
+		lock.unlock();
+		renderTiles(row);
+		lock.lock();
+	}
+}
+
+void RendererSw::renderTiles(vector<uint32>& row) {
+	std::unique_lock lock(tileLock);
+	while (tileNext < tileCount) {
+		int tile = tileNext++;
+		lock.unlock();
+		drawTile(tile, row);
+		lock.lock();
+		if (++tilesDone == tileCount)
+			tileDone.notify_all();
+	}
+}
+
+void RendererSw::drawTile(int tile, vector<uint32>& row) const {
+	int top = drawArea.y + tile * tileHeight;
+	Recti band(drawArea.x, top, drawArea.w, std::min(tileHeight, drawArea.end().y - top));
+	for (int y = band.y; y < band.end().y; ++y)
+		std::fill_n(reinterpret_cast<uint32*>(static_cast<uint8*>(target->pixels) + sizet(y) * sizet(target->pitch)) + band.x, band.w, clearColor);
+	for (const Command& it : commands)
+		drawCommand(it, band, row);
+}
+
+void RendererSw::drawCommand(const Command& cmd, const Recti& band, vector<uint32>& row) const {
+	Recti dst = cmd.dst.intersect(band);
+	if (dst.empty())
+		return;
+
+	bool plain = cmd.color == u16vec4(256);
+	if (row.size() < sizet(dst.w))
+		row.resize(dst.w);
+	for (int y = dst.y; y < dst.end().y; ++y) {
+		uint32* out = reinterpret_cast<uint32*>(static_cast<uint8*>(target->pixels) + sizet(y) * sizet(target->pitch)) + dst.x;
+		if (cmd.tex->solid)
+			blendSolid(out, *cmd.tex->solid, dst.w, cmd.color);
+		else {
+			uint32* src = plain && cmd.tex->opaque ? out : row.data();
+			if (cmd.tex->linear && cmd.rect.size() != cmd.tex->getRes())
+				sampleLinear(src, cmd.tex, cmd, dst.x, y, dst.w);
+			else
+				sampleNearest(src, cmd.tex, cmd, dst.x, y, dst.w);
+			if (src != out)
+				blendRow(out, src, dst.w, cmd.color);
+		}
+	}
+}
+
+void RendererSw::sampleNearest(uint32* dst, const TextureSw* tex, const Command& cmd, int x, int y, int cnt) {
+	ivec2 res = tex->getRes();
+	int sy = std::min(int((int64(y - cmd.rect.y) * 2 + 1) * res.y / (int64(cmd.rect.h) * 2)), res.y - 1);
+	const uint32* src = reinterpret_cast<const uint32*>(static_cast<const uint8*>(tex->img->pixels) + sizet(sy) * sizet(tex->img->pitch));
+	if (cmd.rect.w == res.x) {
+		std::copy_n(src + (x - cmd.rect.x), cnt, dst);
+		return;
+	}
+
+	int64 step = (int64(res.x) << 16) / cmd.rect.w;
+	int64 u = step * (x - cmd.rect.x) + step / 2;
+	for (int i = 0; i < cnt; ++i, u += step)
+		dst[i] = src[std::min(int(u >> 16), res.x - 1)];
+}
+
+void RendererSw::sampleLinear(uint32* dst, const TextureSw* tex, const Command& cmd, int x, int y, int cnt) {
+	ivec2 res = tex->getRes();
+	int64 vstep = (int64(res.y) << 16) / cmd.rect.h;
+	int64 v = vstep * (y - cmd.rect.y) + vstep / 2 - 0x8000;
+	int y0 = std::clamp(int(v >> 16), 0, res.y - 1), y1 = std::clamp(int(v >> 16) + 1, 0, res.y - 1);
+	uint fy = uint(v >> 8) & 0xFF;
+	const uint32* row0 = reinterpret_cast<const uint32*>(static_cast<const uint8*>(tex->img->pixels) + sizet(y0) * sizet(tex->img->pitch));
+	const uint32* row1 = reinterpret_cast<const uint32*>(static_cast<const uint8*>(tex->img->pixels) + sizet(y1) * sizet(tex->img->pitch));
+
+	int64 ustep = (int64(res.x) << 16) / cmd.rect.w;
+	int64 u = ustep * (x - cmd.rect.x) + ustep / 2 - 0x8000;
+	for (int i = 0; i < cnt; ++i, u += ustep) {
+		int x0 = std::clamp(int(u >> 16), 0, res.x - 1), x1 = std::clamp(int(u >> 16) + 1, 0, res.x - 1);
+		uint fx = uint(u >> 8) & 0xFF;
+		dst[i] = lerpPixel(lerpPixel(row0[x0], row0[x1], fx), lerpPixel(row1[x0], row1[x1], fx), fy);
+	}
+}
+
+void RendererSw::blendRow(uint32* dst, const uint32* src, int cnt, const u16vec4& color) {
+	int i = 0;
+#ifdef SW_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(256);
+	const __m128i amask = _mm_set1_epi32(int(0xFF000000));
+	const __m128i cmul = _mm_set_epi16(color[3], color[2], color[1], color[0], color[3], color[2], color[1], color[0]);
+	for (; i + 4 <= cnt; i += 4) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		__m128i lo = blendPair(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), cmul, full);
+		__m128i hi = blendPair(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), cmul, full);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), amask));
+	}
+#endif
+	for (; i < cnt; ++i)
+		dst[i] = blendPixel(dst[i], src[i], color);
+}
+
+void RendererSw::blendSolid(uint32* dst, uint32 src, int cnt, const u16vec4& color) {
+	uint b = (src & 0xFF) * color[0] >> 8;
+	uint g = (src >> 8 & 0xFF) * color[1] >> 8;
+	uint r = (src >> 16 & 0xFF) * color[2] >> 8;
+	uint a = (src >> 24) * color[3] >> 8;
+	a += a >> 7;
+	if (!a)
+		return;
+	if (a == 256) {
+		std::fill_n(dst, cnt, 0xFF000000 | r << 16 | g << 8 | b);
+		return;
+	}
+
+	int i = 0;
+#ifdef SW_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i amask = _mm_set1_epi32(int(0xFF000000));
+	const __m128i ia = _mm_set1_epi16(short(256 - a));
+	const __m128i cs = _mm_set_epi16(0, short(r * a), short(g * a), short(b * a), 0, short(r * a), short(g * a), short(b * a));
+	for (; i + 4 <= cnt; i += 4) {
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		__m128i lo = _mm_srli_epi16(_mm_add_epi16(cs, _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), ia)), 8);
+		__m128i hi = _mm_srli_epi16(_mm_add_epi16(cs, _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), ia)), 8);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), amask));
+	}
+#endif
+	for (uint ia = 256 - a; i < cnt; ++i)
+		dst[i] = 0xFF000000 | ((r * a + (dst[i] >> 16 & 0xFF) * ia) >> 8) << 16 | ((g * a + (dst[i] >> 8 & 0xFF) * ia) >> 8) << 8 | (b * a + (dst[i] & 0xFF) * ia) >> 8;
+}
+
+uint32 RendererSw::packColor(const vec4& color) {
+	u8vec4 c = glm::clamp(color * 255.f + 0.5f, 0.f, 255.f);
+	return 0xFF000000 | uint32(c.r) << 16 | uint32(c.g) << 8 | uint32(c.b);
+}
+
+void RendererSw::startSelDraw(View* view, ivec2 pos) {
+	selPos = pos + view->rect.pos();
+	selected = nullptr;
+}
+
+void RendererSw::drawSelRect(const Widget* wgt, const Recti& rect, const Recti& frame) {
+	if (rect.intersect(frame).contains(selPos))
+		selected = wgt;	// later rects are drawn over earlier ones
+}
+
+Widget* RendererSw::finishSelDraw(View*) {
+	return const_cast<Widget*>(selected);
+}
+
+Texture* RendererSw::texFromImg(SDL_Surface* img, Texture::Owner owner) {
+	TextureSw* tex = createTexture(limitSize(img, maxTexSize), true);
+	return tex ? countTexture(tex, owner, 0, uptrt(tex->img->pitch) * uptrt(tex->img->h)) : nullptr;
+}
+
+Texture* RendererSw::texFromText(SDL_Surface* img) {
+	TextureSw* tex = createTexture(img, false);
+	return tex ? countTexture(tex, Texture::Owner::text, 0, uptrt(tex->img->pitch) * uptrt(tex->img->h)) : nullptr;
+}
+
+void RendererSw::updateText(Texture* tex, const SDL_Surface* img, const Recti& area) {
+	TextureSw* stx = static_cast<TextureSw*>(tex);
+	copyArea(stx->img, img, area);	// glyph pages are already ARGB8888
+	stx->solid.reset();
+}
+
+void RendererSw::freeTexture(Texture* tex) {
+	TextureSw* stx = static_cast<TextureSw*>(tex);
+	uncountTexture(stx);
+	SDL_FreeSurface(stx->img);
+	delete stx;
+}
+
+RendererSw::TextureSw* RendererSw::createTexture(SDL_Surface* img, bool linear) {
+	if (!img)
+		return nullptr;
+	uint32 ckey;
+	bool noAlpha = !SDL_ISPIXELFORMAT_ALPHA(img->format->format) && SDL_GetColorKey(img, &ckey);
+	if (const SDL_Palette* pal = img->format->palette; noAlpha && SDL_ISPIXELFORMAT_INDEXED(img->format->format) && pal)	// palette entries can carry their own alpha
+		noAlpha = std::all_of(pal->colors, pal->colors + pal->ncolors, [](const SDL_Color& it) -> bool { return it.a == SDL_ALPHA_OPAQUE; });
+	if (img->format->format != SDL_PIXELFORMAT_ARGB8888) {
+		SDL_Surface* dst = SDL_ConvertSurfaceFormat(img, SDL_PIXELFORMAT_ARGB8888, 0);
+		SDL_FreeSurface(img);
+		if (img = dst; !img)
+			return nullptr;
+	}
+
+	TextureSw* tex = new TextureSw(img, linear, noAlpha);
+	if (img->w * img->h <= 16) {	// blank textures get filled instead of sampled
+		const uint32* px = static_cast<const uint32*>(img->pixels);
+		bool same = true;
+		for (int y = 0; y < img->h && same; ++y)
+			for (int x = 0; x < img->w && same; ++x)
+				same = reinterpret_cast<const uint32*>(static_cast<const uint8*>(img->pixels) + sizet(y) * sizet(img->pitch))[x] == *px;
+		if (same)
+			tex->solid = *px;
+	}
+	return tex;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "renderer.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// CPU renderer that composites into the window surface in horizontal bands on multiple threads
+class RendererSw : public Renderer {
+private:
+	static constexpr uint32 maxTexSize = 16384;
+	static constexpr int tileHeight = 32;
+	static constexpr uint maxWorkers = 15;
+
+	class TextureSw : public Texture {
+	private:
+		SDL_Surface* img;	// ARGB8888
+		bool linear;		// bilinear filtering when scaled
+		bool opaque;
+		optional<uint32> solid;	// color if every pixel is the same
+
+		TextureSw(SDL_Surface* surface, bool filter, bool noAlpha);
+
+		friend class RendererSw;
+	};
+
+	struct ViewSw : View {
+		SDL_Surface* canvas = nullptr;	// only used when the window surface doesn't have a compatible format
+
+		using View::View;
+	};
+
+	struct Command {
+		const TextureSw* tex;
+		Recti rect, dst;	// dst is the visible part of rect in view space
+		u16vec4 color;		// 0 - 256 in BGRA order
+	};
+
+	vector<Command> commands;
+	vector<std::thread> workers;
+	std::mutex tileLock;
+	std::condition_variable tileWake, tileDone;
+	int tileNext = 0, tileCount = 0, tilesDone = 0;
+	bool stopping = false;
+	SDL_Surface* target = nullptr;
+	ViewSw* curView = nullptr;
+	Recti drawArea;		// in view space
+	uint32 clearColor;
+	ivec2 selPos;
+	const Widget* selected = nullptr;
+
+public:
+	RendererSw(const umap<int, SDL_Window*>& windows, const Settings* sets, ivec2& viewRes, ivec2 origin, const vec4& bgcolor);
+	~RendererSw() final;
+
+	void setClearColor(const vec4& color) final;
+	void setVsync(bool vsync) final;
+	void updateView(ivec2& viewRes) final;
+	void getAdditionalSettings(bool& compression, vector<pair<u32vec2, string>>& devices) final;
+
+	void startDraw(View* view) final;
+	bool startPartialDraw(View* view, const Recti& area) final;
+	void drawRect(const Texture* tex, const Recti& rect, const Recti& frame, const vec4& color) final;
+	void finishDraw(View* view) final;
+
+	void startSelDraw(View* view, ivec2 pos) final;
+	void drawSelRect(const Widget* wgt, const Recti& rect, const Recti& frame) final;
+	Widget* finishSelDraw(View* view) final;
+
+	Texture* texFromImg(SDL_Surface* img, Texture::Owner owner) final;
+	Texture* texFromText(SDL_Surface* img) final;
+	void updateText(Texture* tex, const SDL_Surface* img, const Recti& area) final;
+	void freeTexture(Texture* tex) final;
+
+private:
+	void beginFrame(View* view, const Recti& area);
+	void workerThread();
+	void renderTiles(vector<uint32>& row);
+	void drawTile(int tile, vector<uint32>& row) const;
+	void drawCommand(const Command& cmd, const Recti& band, vector<uint32>& row) const;
+	static void sampleNearest(uint32* dst, const TextureSw* tex, const Command& cmd, int x, int y, int cnt);
+	static void sampleLinear(uint32* dst, const TextureSw* tex, const Command& cmd, int x, int y, int cnt);
+	static void blendRow(uint32* dst, const uint32* src, int cnt, const u16vec4& color);
+	static void blendSolid(uint32* dst, uint32 src, int cnt, const u16vec4& color);
+	static uint32 packColor(const vec4& color);
+	static TextureSw* createTexture(SDL_Surface* img, bool linear);
+};
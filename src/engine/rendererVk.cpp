@@ -1,15 +1,166 @@
 #ifdef WITH_VULKAN
 #include "rendererVk.h"
 #include "utils/settings.h"
+#include "utils/trace.h"
 #include <vulkan/vk_enum_string_helper.h>
 #ifdef _WIN32
 #include <SDL_vulkan.h>
 #else
 #include <SDL2/SDL_vulkan.h>
 #endif
+#include <fstream>
 #include <list>
 #include <set>
 
+// MEMORY ALLOCATOR
+
+static constexpr VkDeviceSize alignUp(VkDeviceSize val, VkDeviceSize alignment) {
+	return (val + alignment - 1) & ~(alignment - 1);
+}
+
+static constexpr bool samePage(VkDeviceSize a, VkDeviceSize b, VkDeviceSize pageSize) {
+	return (a & ~(pageSize - 1)) == (b & ~(pageSize - 1));
+}
+
+MemoryAllocator::Block::Block(VkDeviceMemory mem, VkDeviceSize bsize, uint8* data) :
+	memory(mem),
+	size(bsize),
+	mapped(data),
+	free{ pair(0, bsize) }
+{}
+
+optional<VkDeviceSize> MemoryAllocator::Block::place(const VkMemoryRequirements& req, bool linear, VkDeviceSize granularity) {
+	for (std::map<VkDeviceSize, VkDeviceSize>::iterator it = free.begin(); it != free.end(); ++it) {
+		auto [fofs, fsize] = *it;
+		if (fsize < req.size)
+			continue;
+
+		// linear and optimal resources mustn't share a page of bufferImageGranularity
+		VkDeviceSize start = alignUp(fofs, req.alignment);
+		std::map<VkDeviceSize, Range>::iterator next = used.lower_bound(fofs);
+		if (next != used.begin())
+			if (std::map<VkDeviceSize, Range>::iterator prev = std::prev(next); prev->second.linear != linear && samePage(prev->first + prev->second.size - 1, start, granularity))
+				start = alignUp(start, granularity);
+		VkDeviceSize end = start + req.size;
+		if (end > fofs + fsize || (next != used.end() && next->second.linear != linear && samePage(end - 1, next->first, granularity)))
+			continue;
+
+		free.erase(it);
+		if (start > fofs)
+			free.emplace(fofs, start - fofs);
+		if (end < fofs + fsize)
+			free.emplace(end, fofs + fsize - end);
+		used.emplace(start, Range{ req.size, linear });
+		return start;
+	}
+	return std::nullopt;
+}
+
+void MemoryAllocator::Block::release(VkDeviceSize offset) {
+	std::map<VkDeviceSize, Range>::iterator it = used.find(offset);
+	if (it == used.end())
+		return;
+	VkDeviceSize end = offset + it->second.size;
+	used.erase(it);
+
+	if (std::map<VkDeviceSize, VkDeviceSize>::iterator next = free.find(end); next != free.end()) {
+		end += next->second;
+		free.erase(next);
+	}
+	if (std::map<VkDeviceSize, VkDeviceSize>::iterator prev = free.lower_bound(offset); prev != free.begin() && (--prev)->first + prev->second == offset)
+		prev->second = end - prev->first;
+	else
+		free.emplace(offset, end - offset);
+}
+
+void MemoryAllocator::init(VkDevice device, const VkPhysicalDeviceProperties& prop, const VkPhysicalDeviceMemoryProperties& memp) {
+	dev = device;
+	granularity = std::max(prop.limits.bufferImageGranularity, VkDeviceSize(1));
+	memProperties = memp;
+	pools.resize(memp.memoryTypeCount);
+}
+
+MemoryAllocator::Allocation MemoryAllocator::allocate(uint32 type, const VkMemoryRequirements& req, bool linear) {
+	Block* blk = nullptr;
+	optional<VkDeviceSize> ofs;
+	for (Block& it : pools[type])
+		if (ofs = it.place(req, linear, granularity); ofs) {
+			blk = &it;
+			break;
+		}
+	if (!blk) {
+		blk = &createBlock(type, req.size);
+		ofs = blk->place(req, linear, granularity);
+	}
+	return Allocation{ blk->memory, *ofs, req.size, blk->mapped ? blk->mapped + *ofs : nullptr, type };
+}
+
+MemoryAllocator::Block& MemoryAllocator::createBlock(uint32 type, VkDeviceSize minSize) {
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = std::max(blockSize(type), minSize);
+	allocInfo.memoryTypeIndex = type;
+
+	VkDeviceMemory memory;
+	if (VkResult rs = vkAllocateMemory(dev, &allocInfo, nullptr, &memory); rs != VK_SUCCESS) {
+		if (allocInfo.allocationSize == minSize)
+			throw std::runtime_error("Failed to allocate device memory: "s + string_VkResult(rs));
+		allocInfo.allocationSize = minSize;	// the heap might still fit a smaller block
+		if (rs = vkAllocateMemory(dev, &allocInfo, nullptr, &memory); rs != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate device memory: "s + string_VkResult(rs));
+	}
+
+	void* mapped = nullptr;
+	if (memProperties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		if (VkResult rs = vkMapMemory(dev, memory, 0, VK_WHOLE_SIZE, 0, &mapped); rs != VK_SUCCESS) {
+			vkFreeMemory(dev, memory, nullptr);
+			throw std::runtime_error("Failed to map device memory: "s + string_VkResult(rs));
+		}
+	return pools[type].emplace_back(memory, allocInfo.allocationSize, static_cast<uint8*>(mapped));
+}
+
+VkDeviceSize MemoryAllocator::blockSize(uint32 type) const {
+	const VkMemoryType& mtype = memProperties.memoryTypes[type];
+	VkDeviceSize size = mtype.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ? hostBlockSize : deviceBlockSize;
+	return std::min(size, memProperties.memoryHeaps[mtype.heapIndex].size / smallHeapFraction);
+}
+
+void MemoryAllocator::free(const Allocation& alc) {
+	if (alc.memory == VK_NULL_HANDLE)
+		return;
+	vector<Block>& pool = pools[alc.type];
+	vector<Block>::iterator blk = std::find_if(pool.begin(), pool.end(), [&alc](const Block& it) -> bool { return it.memory == alc.memory; });
+	if (blk == pool.end())
+		return;
+
+	// keep one empty block around to not thrash when a batch of textures gets replaced
+	if (blk->release(alc.offset); blk->used.empty() && (blk->size > blockSize(alc.type) || std::count_if(pool.begin(), pool.end(), [](const Block& it) -> bool { return it.used.empty(); }) > 1)) {
+		vkFreeMemory(dev, blk->memory, nullptr);
+		pool.erase(blk);
+	}
+}
+
+void MemoryAllocator::free() {
+	for (vector<Block>& pool : pools)
+		for (Block& blk : pool)
+			vkFreeMemory(dev, blk.memory, nullptr);
+	pools.clear();
+}
+
+MemoryAllocator::Stats MemoryAllocator::getStats(VkMemoryPropertyFlags properties) const {
+	Stats stats;
+	for (uint32 i = 0; i < pools.size(); ++i)
+		if ((memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			for (const Block& blk : pools[i]) {
+				stats.reserved += blk.size;
+				++stats.blocks;
+				for (const auto& [ofs, rng] : blk.used)
+					stats.used += rng.size;
+				stats.allocations += blk.used.size();
+			}
+	return stats;
+}
+
 // GENERIC PASS
 
 VkSampler GenericPass::createSampler(VkDevice dev, VkFilter filter) {
@@ -54,7 +205,7 @@ vector<VkDescriptorSet> RenderPass::init(const RendererVk* rend, VkFormat format
 	createRenderPass(rend->getLogicalDevice(), format);
 	samplers = { createSampler(rend->getLogicalDevice(), VK_FILTER_LINEAR), createSampler(rend->getLogicalDevice(), VK_FILTER_NEAREST) };
 	createDescriptorSetLayout(rend->getLogicalDevice());
-	createPipeline(rend->getLogicalDevice());
+	createPipeline(rend->getLogicalDevice(), rend->getPipelineCache());
 	return createDescriptorPoolAndSets(rend->getLogicalDevice(), numViews);
 }
 
@@ -129,7 +280,7 @@ void RenderPass::createDescriptorSetLayout(VkDevice dev) {
 		throw std::runtime_error("Failed to create descriptor set layout 1: "s + string_VkResult(rs));
 }
 
-void RenderPass::createPipeline(VkDevice dev) {
+void RenderPass::createPipeline(VkDevice dev, VkPipelineCache cache) {
 	constexpr uint32 vertCode[] = {
 #ifdef NDEBUG
 #include "shaders/vk.gui.vert.rel.h"
@@ -228,7 +379,7 @@ void RenderPass::createPipeline(VkDevice dev) {
 	pipelineInfo.layout = pipelineLayout;
 	pipelineInfo.renderPass = handle;
 	pipelineInfo.subpass = 0;
-	if (VkResult rs = vkCreateGraphicsPipelines(dev, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline); rs != VK_SUCCESS)
+	if (VkResult rs = vkCreateGraphicsPipelines(dev, cache, 1, &pipelineInfo, nullptr, &pipeline); rs != VK_SUCCESS)
 		throw std::runtime_error("Failed to create graphics pipeline: "s + string_VkResult(rs));
 
 	vkDestroyShaderModule(dev, fragShaderModule, nullptr);
@@ -367,7 +518,7 @@ void RenderPass::free(VkDevice dev) {
 void AddressPass::init(const RendererVk* rend) {
 	createRenderPass(rend->getLogicalDevice());
 	createDescriptorSetLayout(rend->getLogicalDevice());
-	createPipeline(rend->getLogicalDevice());
+	createPipeline(rend->getLogicalDevice(), rend->getPipelineCache());
 	createUniformBuffer(rend);
 	createDescriptorPoolAndSet(rend->getLogicalDevice());
 	updateDescriptorSet(rend->getLogicalDevice());
@@ -428,7 +579,7 @@ void AddressPass::createDescriptorSetLayout(VkDevice dev) {
 		throw std::runtime_error("Failed to create descriptor set layout: "s + string_VkResult(rs));
 }
 
-void AddressPass::createPipeline(VkDevice dev) {
+void AddressPass::createPipeline(VkDevice dev, VkPipelineCache cache) {
 	constexpr uint32 vertCode[] = {
 #ifdef NDEBUG
 #include "shaders/vk.sel.vert.rel.h"
@@ -525,7 +676,7 @@ void AddressPass::createPipeline(VkDevice dev) {
 	pipelineInfo.renderPass = handle;
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-	if (VkResult rs = vkCreateGraphicsPipelines(dev, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline); rs != VK_SUCCESS)
+	if (VkResult rs = vkCreateGraphicsPipelines(dev, cache, 1, &pipelineInfo, nullptr, &pipeline); rs != VK_SUCCESS)
 		throw std::runtime_error("Failed to create graphics pipeline: "s + string_VkResult(rs));
 
 	vkDestroyShaderModule(dev, fragShaderModule, nullptr);
@@ -534,8 +685,7 @@ void AddressPass::createPipeline(VkDevice dev) {
 
 void AddressPass::createUniformBuffer(const RendererVk* rend) {
 	std::tie(uniformBuffer, uniformBufferMemory) = rend->createBuffer(sizeof(UniformData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	if (VkResult rs = vkMapMemory(rend->getLogicalDevice(), uniformBufferMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&uniformBufferMapped)); rs != VK_SUCCESS)
-		throw std::runtime_error("Failed to map uniform buffer memory: "s + string_VkResult(rs));
+	uniformBufferMapped = reinterpret_cast<UniformData*>(uniformBufferMemory.mapped);
 }
 
 void AddressPass::createDescriptorPoolAndSet(VkDevice dev) {
@@ -575,19 +725,19 @@ void AddressPass::updateDescriptorSet(VkDevice dev) {
 	vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
 }
 
-void AddressPass::free(VkDevice dev) {
+void AddressPass::free(const RendererVk* rend) {
+	VkDevice dev = rend->getLogicalDevice();
 	vkDestroyPipeline(dev, pipeline, nullptr);
 	vkDestroyPipelineLayout(dev, pipelineLayout, nullptr);
 	vkDestroyRenderPass(dev, handle, nullptr);
-	vkDestroyBuffer(dev, uniformBuffer, nullptr);
-	vkFreeMemory(dev, uniformBufferMemory, nullptr);
+	rend->freeBuffer(uniformBuffer, uniformBufferMemory);
 	vkDestroyDescriptorPool(dev, descriptorPool, nullptr);
 	vkDestroyDescriptorSetLayout(dev, descriptorSetLayout, nullptr);
 }
 
 // RENDERER VK
 
-RendererVk::TextureVk::TextureVk(ivec2 size, VkImage img, VkDeviceMemory mem, VkImageView imageView, VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet, uint samplerId) :
+RendererVk::TextureVk::TextureVk(ivec2 size, VkImage img, const MemoryAllocator::Allocation& mem, VkImageView imageView, VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet, uint samplerId) :
 	Texture(size),
 	image(img),
 	memory(mem),
@@ -597,7 +747,8 @@ RendererVk::TextureVk::TextureVk(ivec2 size, VkImage img, VkDeviceMemory mem, Vk
 	sid(samplerId)
 {}
 
-RendererVk::RendererVk(const umap<int, SDL_Window*>& windows, Settings* sets, ivec2& viewRes, ivec2 origin, const vec4& bgcolor) :
+RendererVk::RendererVk(const umap<int, SDL_Window*>& windows, Settings* sets, const fs::path& dirSets, ivec2& viewRes, ivec2 origin, const vec4& bgcolor) :
+	pipelineCachePath(dirSets / filePipelineCache),
 	bgColor{ { { bgcolor.r, bgcolor.g, bgcolor.b, bgcolor.a } } }
 {
 	createInstance(windows.begin()->second);	// using just one window to get extensions should be fine
@@ -618,8 +769,11 @@ RendererVk::RendererVk(const umap<int, SDL_Window*>& windows, Settings* sets, iv
 	}
 	pickPhysicalDevice(sets->device);
 	createDevice();
+	allocator.init(ldev, pdevProperties, pdevMemProperties);
 	singleTimeFence = createFence();
 	createCommandPool();
+	createPipelineCache();
+	createTimerPool();
 	setPresentMode(sets->vsync);
 
 	umap<VkFormat, uint> formatCounter;
@@ -640,6 +794,7 @@ RendererVk::RendererVk(const umap<int, SDL_Window*>& windows, Settings* sets, iv
 
 		createUniformBuffer(vw);
 		vw->uniformMapped->pview = vec4(vw->rect.pos(), vec2(vw->rect.size()) / 2.f);
+		vw->timerIndex = uint32(d);
 		vw->descriptorSet = descriptorSets[d++];
 		renderPass.updateDescriptorSet(ldev, vw->descriptorSet, vw->uniformBuffer);
 	}
@@ -649,8 +804,7 @@ RendererVk::RendererVk(const umap<int, SDL_Window*>& windows, Settings* sets, iv
 	addrView = createImageView(addrImage, VK_IMAGE_VIEW_TYPE_1D, AddressPass::format);
 	addrFramebuffer = createFramebuffer(addressPass.getHandle(), addrView, u32vec2(1));
 	std::tie(addrBuffer, addrBufferMemory) = createBuffer(sizeof(u32vec2), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	if (VkResult rs = vkMapMemory(ldev, addrBufferMemory, 0, sizeof(u32vec2), 0, reinterpret_cast<void**>(&addrMappedMemory)); rs != VK_SUCCESS)
-		throw std::runtime_error("Failed to map address lookup memory: "s + string_VkResult(rs));
+	addrMappedMemory = reinterpret_cast<u32vec2*>(addrBufferMemory.mapped);
 	allocateCommandBuffers(&commandBufferAddr, 1);
 	addrFence = createFence();
 }
@@ -666,8 +820,7 @@ RendererVk::~RendererVk() {
 	renderPass.free(ldev);
 	for (auto [id, view] : views) {
 		ViewVk* vw = static_cast<ViewVk*>(view);
-		vkDestroyBuffer(ldev, vw->uniformBuffer, nullptr);
-		vkFreeMemory(ldev, vw->uniformMemory, nullptr);
+		freeBuffer(vw->uniformBuffer, vw->uniformMemory);
 
 		for (uint i = 0; i < ViewVk::maxFrames; ++i) {
 			vkDestroySemaphore(ldev, vw->renderFinishedSemaphores[i], nullptr);
@@ -676,18 +829,20 @@ RendererVk::~RendererVk() {
 		}
 	}
 
-	addressPass.free(ldev);
+	addressPass.free(this);
 	vkDestroyFramebuffer(ldev, addrFramebuffer, nullptr);
 	vkDestroyImageView(ldev, addrView, nullptr);
-	vkDestroyImage(ldev, addrImage, nullptr);
-	vkFreeMemory(ldev, addrImageMemory, nullptr);
-	vkDestroyBuffer(ldev, addrBuffer, nullptr);
-	vkFreeMemory(ldev, addrBufferMemory, nullptr);
+	freeImage(addrImage, addrImageMemory);
+	freeBuffer(addrBuffer, addrBufferMemory);
 	vkFreeCommandBuffers(ldev, cmdPool, 1, &commandBufferAddr);
 	vkDestroyFence(ldev, addrFence, nullptr);
+	vkDestroyQueryPool(ldev, timerPool, nullptr);
 
+	savePipelineCache();
+	vkDestroyPipelineCache(ldev, pipelineCache, nullptr);
 	vkDestroyCommandPool(ldev, cmdPool, nullptr);
 	vkDestroyFence(ldev, singleTimeFence, nullptr);
+	allocator.free();
 	vkDestroyDevice(ldev, nullptr);
 #ifndef NDEBUG
 	if (dbgMessenger != VK_NULL_HANDLE)
@@ -855,6 +1010,109 @@ void RendererVk::createCommandPool() {
 		throw std::runtime_error("Failed to create command pool: "s + string_VkResult(rs));
 }
 
+void RendererVk::createPipelineCache() {
+	vector<uint8> data;
+	if (std::ifstream ifh(pipelineCachePath, std::ios::binary | std::ios::ate); ifh.good())
+		if (std::streampos len = ifh.tellg(); len != -1 && sizet(len) > sizeof(PipelineCacheHeader)) {
+			ifh.seekg(0);
+			data.resize(len);
+			if (ifh.read(reinterpret_cast<char*>(data.data()), data.size()); sizet(ifh.gcount()) != data.size())
+				data.clear();
+		}
+
+	// discard the file if it's truncated, corrupted or from a different device or driver
+	const uint8* initData = nullptr;
+	sizet initSize = 0;
+	if (!data.empty()) {
+		PipelineCacheHeader header;
+		memcpy(&header, data.data(), sizeof(header));
+		initData = data.data() + sizeof(header);
+		initSize = data.size() - sizeof(header);
+		if (PipelineCacheHeader expect = makePipelineCacheHeader(initData, initSize); memcmp(&header, &expect, sizeof(header))) {
+			logInfo("Discarding stale pipeline cache ", pipelineCachePath);
+			initData = nullptr;
+			initSize = 0;
+		}
+	}
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = initSize;
+	createInfo.pInitialData = initData;
+	if (VkResult rs = vkCreatePipelineCache(ldev, &createInfo, nullptr, &pipelineCache); rs != VK_SUCCESS) {
+		logError("Failed to load pipeline cache: ", string_VkResult(rs));
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = nullptr;
+		if (rs = vkCreatePipelineCache(ldev, &createInfo, nullptr, &pipelineCache); rs != VK_SUCCESS) {
+			logError("Failed to create pipeline cache: ", string_VkResult(rs));
+			pipelineCache = VK_NULL_HANDLE;
+		}
+	}
+}
+
+void RendererVk::savePipelineCache() const {
+	if (pipelineCache == VK_NULL_HANDLE)
+		return;
+	sizet size;
+	if (VkResult rs = vkGetPipelineCacheData(ldev, pipelineCache, &size, nullptr); rs != VK_SUCCESS || !size)
+		return;
+	vector<uint8> data(sizeof(PipelineCacheHeader) + size);
+	if (VkResult rs = vkGetPipelineCacheData(ldev, pipelineCache, &size, data.data() + sizeof(PipelineCacheHeader)); rs != VK_SUCCESS) {
+		logError("Failed to get pipeline cache data: ", string_VkResult(rs));
+		return;
+	}
+	PipelineCacheHeader header = makePipelineCacheHeader(data.data() + sizeof(header), size);
+	memcpy(data.data(), &header, sizeof(header));
+
+	// write to a temporary file first so that a crash can't leave a half written cache behind
+	fs::path tmp = fs::path(pipelineCachePath).concat(".tmp");
+	if (std::ofstream ofh(tmp, std::ios::binary); !ofh.write(reinterpret_cast<const char*>(data.data()), sizeof(header) + size)) {
+		logError("Failed to write pipeline cache ", tmp);
+		return;
+	}
+	try {
+		fs::rename(tmp, pipelineCachePath);
+	} catch (const std::runtime_error& err) {
+		logError(err.what());
+		std::error_code ec;
+		fs::remove(tmp, ec);
+	}
+}
+
+RendererVk::PipelineCacheHeader RendererVk::makePipelineCacheHeader(const uint8* data, sizet size) const {
+	PipelineCacheHeader header{};	// zero padding for memcmp
+	header.magic = pipelineCacheMagic;
+	header.vendorID = pdevProperties.vendorID;
+	header.deviceID = pdevProperties.deviceID;
+	header.driverVersion = pdevProperties.driverVersion;
+	std::copy_n(pdevProperties.pipelineCacheUUID, VK_UUID_SIZE, header.uuid.begin());
+	header.dataSize = size;
+	header.checksum = 0xCBF29CE484222325;	// FNV-1a
+	for (sizet i = 0; i < size; ++i)
+		header.checksum = (header.checksum ^ data[i]) * 0x100000001B3;
+	return header;
+}
+
+void RendererVk::createTimerPool() {
+	uint32 count;
+	vkGetPhysicalDeviceQueueFamilyProperties(pdev, &count, nullptr);
+	vector<VkQueueFamilyProperties> families(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(pdev, &count, families.data());
+	uint32 bits = families[gfamilyIndex].timestampValidBits;
+	if (!bits || pdevProperties.limits.timestampPeriod <= 0.f)
+		return;
+
+	timestampMask = bits < 64 ? (uint64(1) << bits) - 1 : UINT64_MAX;
+	VkQueryPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = timerQueryDraw + ViewVk::maxFrames * uint32(views.size()) * 2;
+	if (VkResult rs = vkCreateQueryPool(ldev, &poolInfo, nullptr, &timerPool); rs != VK_SUCCESS) {
+		timerPool = VK_NULL_HANDLE;
+		logError("Failed to create query pool: ", string_VkResult(rs));
+	}
+}
+
 VkFormat RendererVk::createSwapchain(ViewVk* view, VkSwapchainKHR oldSwapchain) {
 	VkSurfaceCapabilitiesKHR capabilities;
 	if (VkResult rs = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(pdev, view->surface, &capabilities); rs != VK_SUCCESS)
@@ -933,8 +1191,7 @@ void RendererVk::createFramebuffers(ViewVk* view) {
 
 void RendererVk::createUniformBuffer(ViewVk* view) {
 	std::tie(view->uniformBuffer, view->uniformMemory) = createBuffer(sizeof(RenderPass::UniformData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	if (VkResult rs = vkMapMemory(ldev, view->uniformMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&view->uniformMapped)); rs != VK_SUCCESS)
-		throw std::runtime_error("Failed to map uniform buffer memory 1: "s + string_VkResult(rs));
+	view->uniformMapped = reinterpret_cast<RenderPass::UniformData*>(view->uniformMemory.mapped);
 }
 
 void RendererVk::setClearColor(const vec4& color) {
@@ -973,6 +1230,12 @@ void RendererVk::updateView(ivec2& viewRes) {
 void RendererVk::startDraw(View* view) {
 	currentView = static_cast<ViewVk*>(view);
 	vkWaitForFences(ldev, 1, &currentView->frameFences[currentFrame], VK_TRUE, UINT64_MAX);
+	if (currentView->timed[currentFrame]) {
+		// the fence guarantees that the timestamps of this view's last use of the frame are written
+		timerSums.ms[uint8(GpuPass::draw)] += readTimer(drawTimerQuery(currentView));
+		timerSums.valid = true;
+		currentView->timed[currentFrame] = false;
+	}
 	if (VkResult rs = vkAcquireNextImageKHR(ldev, currentView->swapchain, UINT64_MAX, currentView->imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex); rs == VK_ERROR_OUT_OF_DATE_KHR) {
 		recreateSwapchain(currentView);
 		throw ErrorSkip();
@@ -986,6 +1249,7 @@ void RendererVk::startDraw(View* view) {
 	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;	// true but retarded
 	if (VkResult rs = vkBeginCommandBuffer(currentView->commandBuffers[currentFrame], &beginInfo); rs != VK_SUCCESS)
 		throw std::runtime_error("Failed to begin recording command buffer: "s + string_VkResult(rs));
+	beginTimer(currentView->commandBuffers[currentFrame], drawTimerQuery(currentView));
 
 	VkRenderPassBeginInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1022,6 +1286,7 @@ void RendererVk::drawRect(const Texture* tex, const Recti& rect, const Recti& fr
 
 void RendererVk::finishDraw(View*) {
 	vkCmdEndRenderPass(currentView->commandBuffers[currentFrame]);
+	endTimer(currentView->commandBuffers[currentFrame], drawTimerQuery(currentView));
 	if (VkResult rs = vkEndCommandBuffer(currentView->commandBuffers[currentFrame]); rs != VK_SUCCESS)
 		throw std::runtime_error("Failed to end recording command buffer: "s + string_VkResult(rs));
 
@@ -1039,6 +1304,7 @@ void RendererVk::finishDraw(View*) {
 	submitInfo.pSignalSemaphores = signalSemaphores.data();
 	if (VkResult rs = vkQueueSubmit(gqueue, 1, &submitInfo, currentView->frameFences[currentFrame]); rs != VK_SUCCESS)
 		throw std::runtime_error("Failed to submit draw command buffer: "s + string_VkResult(rs));
+	currentView->timed[currentFrame] = timerPool != VK_NULL_HANDLE;
 
 	array<VkSwapchainKHR, 1> swapChains = { currentView->swapchain };
 	VkPresentInfoKHR presentInfo{};
@@ -1055,9 +1321,37 @@ void RendererVk::finishDraw(View*) {
 }
 
 void RendererVk::finishRender() {
+	// selection and upload times are synchronous, so they're published along with the delayed draw times
+	if (timerSums.valid) {
+		gpuTimes = timerSums;
+		timerSums = GpuTimes();
+	}
 	currentFrame = (currentFrame + 1) % ViewVk::maxFrames;
 }
 
+uint32 RendererVk::drawTimerQuery(const ViewVk* view) const {
+	return timerQueryDraw + (currentFrame * uint32(views.size()) + view->timerIndex) * 2;
+}
+
+void RendererVk::beginTimer(VkCommandBuffer commandBuffer, uint32 query) const {
+	if (timerPool) {
+		vkCmdResetQueryPool(commandBuffer, timerPool, query, 2);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timerPool, query);
+	}
+}
+
+void RendererVk::endTimer(VkCommandBuffer commandBuffer, uint32 query) const {
+	if (timerPool)
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timerPool, query + 1);
+}
+
+float RendererVk::readTimer(uint32 query) const {
+	array<uint64, 2> ticks;
+	if (!timerPool || vkGetQueryPoolResults(ldev, timerPool, query, ticks.size(), sizeof(ticks), ticks.data(), sizeof(uint64), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+		return 0.f;
+	return float((ticks[1] - ticks[0]) & timestampMask) * pdevProperties.limits.timestampPeriod / 1'000'000.f;
+}
+
 void RendererVk::startSelDraw(View* view, ivec2 pos) {
 	ViewVk* vkw = static_cast<ViewVk*>(view);
 	addressPass.getUniformBufferMapped()->pview = vec4(vkw->rect.pos(), vec2(vkw->rect.size()) / 2.f);
@@ -1067,6 +1361,7 @@ void RendererVk::startSelDraw(View* view, ivec2 pos) {
 	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	if (VkResult rs = vkBeginCommandBuffer(commandBufferAddr, &beginInfo); rs != VK_SUCCESS)
 		throw std::runtime_error("Failed to begin recording command buffer: "s + string_VkResult(rs));
+	beginTimer(commandBufferAddr, timerQuerySelect);
 
 	VkClearValue zero{};
 	VkRenderPassBeginInfo renderPassInfo{};
@@ -1103,6 +1398,7 @@ Widget* RendererVk::finishSelDraw(View*) {
 	vkCmdEndRenderPass(commandBufferAddr);
 	transitionImageLayout<VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL>(commandBufferAddr, addrImage);
 	copyImageToBuffer(commandBufferAddr, addrImage, addrBuffer, u32vec2(1));
+	endTimer(commandBufferAddr, timerQuerySelect);
 	if (VkResult rs = vkEndCommandBuffer(commandBufferAddr); rs != VK_SUCCESS)
 		throw std::runtime_error("Failed to end recording command buffer: "s + string_VkResult(rs));
 
@@ -1115,77 +1411,121 @@ Widget* RendererVk::finishSelDraw(View*) {
 	vkWaitForFences(ldev, 1, &addrFence, VK_TRUE, UINT64_MAX);
 	vkResetFences(ldev, 1, &addrFence);
 	vkResetCommandBuffer(commandBufferAddr, 0);
+	timerSums.ms[uint8(GpuPass::select)] += readTimer(timerQuerySelect);
 	return reinterpret_cast<Widget*>(uptrt(addrMappedMemory->x) | (uptrt(addrMappedMemory->y) << 32));
 }
 
-Texture* RendererVk::texFromImg(SDL_Surface* img) {
-	if (auto [pic, fmt] = pickPixFormat(img); pic)
-		return createTexture(pic, u32vec2(pic->w, pic->h), fmt, false);
-	return nullptr;
+Texture* RendererVk::texFromImg(SDL_Surface* img, Texture::Owner owner) {
+	SDL_Surface* pic;
+	VkFormat fmt;
+	{
+		Trace::Zone zone("convert");
+		std::tie(pic, fmt) = pickPixFormat(img);
+	}
+	if (!pic)
+		return nullptr;
+
+	Trace::Zone zone("upload");
+	zone.setBytes(uptrt(pic->pitch) * uptrt(pic->h));
+	TextureVk* tex = createTexture(pic, u32vec2(pic->w, pic->h), fmt, false);
+	return tex ? countTexture(tex, owner, tex->memory.size) : nullptr;
 }
 
 Texture* RendererVk::texFromText(SDL_Surface* img) {
-	return img ? createTexture(img, glm::min(u32vec2(img->w, img->h), u32vec2(pdevProperties.limits.maxImageDimension2D)), VK_FORMAT_A8B8G8R8_UNORM_PACK32, true) : nullptr;
+	TextureVk* tex = img ? createTexture(img, glm::min(u32vec2(img->w, img->h), u32vec2(pdevProperties.limits.maxImageDimension2D)), VK_FORMAT_A8B8G8R8_UNORM_PACK32, true) : nullptr;
+	return tex ? countTexture(tex, Texture::Owner::text, tex->memory.size) : nullptr;
+}
+
+void RendererVk::updateText(Texture* tex, const SDL_Surface* img, const Recti& area) {
+	TextureVk* vtx = static_cast<TextureVk*>(tex);
+	VkBuffer stagingBuffer = VK_NULL_HANDLE;
+	MemoryAllocator::Allocation stagingMemory;
+	try {
+		// only the rows of the area get staged, the copy skips the columns around it
+		uint32 bpp = img->format->BytesPerPixel;
+		VkDeviceSize offset = VkDeviceSize(area.y) * VkDeviceSize(img->pitch) + VkDeviceSize(area.x) * bpp;
+		VkDeviceSize bufferSize = VkDeviceSize(area.h - 1) * VkDeviceSize(img->pitch) + VkDeviceSize(area.w) * bpp;
+		std::tie(stagingBuffer, stagingMemory) = createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		memcpy(stagingMemory.mapped, static_cast<const uint8*>(img->pixels) + offset, bufferSize);
+
+		vkQueueWaitIdle(gqueue);	// a frame in flight may still be sampling it
+		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+		beginTimer(commandBuffer, timerQueryUpload);
+		transitionImageLayout<VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL>(commandBuffer, vtx->image);
+		copyBufferToImage(commandBuffer, stagingBuffer, vtx->image, u32vec2(area.size()), img->pitch / bpp, area.pos());
+		transitionImageLayout<VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL>(commandBuffer, vtx->image);
+		endTimer(commandBuffer, timerQueryUpload);
+		endSingleTimeCommands(commandBuffer);
+		timerSums.ms[uint8(GpuPass::upload)] += readTimer(timerQueryUpload);
+	} catch (const std::runtime_error& err) {
+		logError(err.what());
+	}
+	freeBuffer(stagingBuffer, stagingMemory);
 }
 
 void RendererVk::freeTexture(Texture* tex) {
 	TextureVk* vtx = static_cast<TextureVk*>(tex);
+	uncountTexture(vtx);
 	vkQueueWaitIdle(gqueue);
 	renderPass.freeDescriptorSetTex(ldev, vtx->pool, vtx->set);
 	vkDestroyImageView(ldev, vtx->view, nullptr);
-	vkDestroyImage(ldev, vtx->image, nullptr);
-	vkFreeMemory(ldev, vtx->memory, nullptr);
+	freeImage(vtx->image, vtx->memory);
 	delete vtx;
 }
 
+// textures go into the largest device local heap, which on integrated GPUs is also shared with the system
+uptrt RendererVk::deviceMemory() const {
+	VkDeviceSize size = 0;
+	for (uint32 i = 0; i < pdevMemProperties.memoryHeapCount; ++i)
+		if (pdevMemProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			size = std::max(size, pdevMemProperties.memoryHeaps[i].size);
+	return uptrt(size);
+}
+
 RendererVk::TextureVk* RendererVk::createTexture(SDL_Surface* img, u32vec2 res, VkFormat format, bool nearest) {
 	VkBuffer stagingBuffer = VK_NULL_HANDLE;
-	VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+	MemoryAllocator::Allocation stagingMemory;
 	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
 	VkImage image = VK_NULL_HANDLE;
-	VkDeviceMemory memory = VK_NULL_HANDLE;
+	MemoryAllocator::Allocation memory;
 	VkImageView view = VK_NULL_HANDLE;
 	VkDescriptorPool pool = VK_NULL_HANDLE;
 	VkDescriptorSet dset = VK_NULL_HANDLE;
 	try {
 		VkDeviceSize bufferSize = VkDeviceSize(img->pitch) * VkDeviceSize(res.y);
 		std::tie(stagingBuffer, stagingMemory) = createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-		void* stagingMapped;
-		if (VkResult rs = vkMapMemory(ldev, stagingMemory, 0, VK_WHOLE_SIZE, 0, &stagingMapped); rs != VK_SUCCESS)
-			throw std::runtime_error("Failed to map texture staging memory: "s + string_VkResult(rs));
-		memcpy(stagingMapped, img->pixels, bufferSize);
-		vkUnmapMemory(ldev, stagingMemory);
+		memcpy(stagingMemory.mapped, img->pixels, bufferSize);
 
 		std::tie(image, memory) = createImage(res, VK_IMAGE_TYPE_2D, format, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 		commandBuffer = beginSingleTimeCommands();
+		beginTimer(commandBuffer, timerQueryUpload);
 		transitionImageLayout<VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL>(commandBuffer, image);
 		copyBufferToImage(commandBuffer, stagingBuffer, image, res, img->pitch / img->format->BytesPerPixel);
 		transitionImageLayout<VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL>(commandBuffer, image);
+		endTimer(commandBuffer, timerQueryUpload);
 		endSingleTimeCommands(commandBuffer);
+		timerSums.ms[uint8(GpuPass::upload)] += readTimer(timerQueryUpload);
 
 		view = createImageView(image, VK_IMAGE_VIEW_TYPE_2D, format);
 		std::tie(pool, dset) = renderPass.newDescriptorSetTex(ldev);
 		RenderPass::updateDescriptorSet(ldev, dset, view);
 
-		vkDestroyBuffer(ldev, stagingBuffer, nullptr);
-		vkFreeMemory(ldev, stagingMemory, nullptr);
+		freeBuffer(stagingBuffer, stagingMemory);
 		SDL_FreeSurface(img);
 	} catch (const std::runtime_error& err) {
 		logError(err.what());
 		freeCommandBuffers(&commandBuffer, 1);
 		renderPass.freeDescriptorSetTex(ldev, pool, dset);
 		vkDestroyImageView(ldev, view, nullptr);
-		vkDestroyImage(ldev, image, nullptr);
-		vkFreeMemory(ldev, memory, nullptr);
-		vkDestroyBuffer(ldev, stagingBuffer, nullptr);
-		vkFreeMemory(ldev, stagingMemory, nullptr);
+		freeImage(image, memory);
+		freeBuffer(stagingBuffer, stagingMemory);
 		SDL_FreeSurface(img);
 		return nullptr;
 	}
 	return new TextureVk(res, image, memory, view, pool, dset, nearest);
 }
 
-pair<VkImage, VkDeviceMemory> RendererVk::createImage(u32vec2 size, VkImageType type, VkFormat format, VkImageUsageFlags usage, VkMemoryPropertyFlags properties) const {
+pair<VkImage, MemoryAllocator::Allocation> RendererVk::createImage(u32vec2 size, VkImageType type, VkFormat format, VkImageUsageFlags usage, VkMemoryPropertyFlags properties) const {
 	VkImageCreateInfo imageInfo{};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageInfo.imageType = type;
@@ -1206,20 +1546,25 @@ pair<VkImage, VkDeviceMemory> RendererVk::createImage(u32vec2 size, VkImageType
 	VkMemoryRequirements memRequirements;
 	vkGetImageMemoryRequirements(ldev, image, &memRequirements);
 
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-	VkDeviceMemory memory;
-	if (VkResult rs = vkAllocateMemory(ldev, &allocInfo, nullptr, &memory); rs != VK_SUCCESS) {
+	MemoryAllocator::Allocation memory;
+	try {
+		memory = allocator.allocate(findMemoryType(memRequirements.memoryTypeBits, properties), memRequirements, false);
+	} catch (const std::runtime_error&) {
 		vkDestroyImage(ldev, image, nullptr);
-		throw std::runtime_error("Failed to allocate image memory: "s + string_VkResult(rs));
+		throw;
+	}
+	if (VkResult rs = vkBindImageMemory(ldev, image, memory.memory, memory.offset); rs != VK_SUCCESS) {
+		freeImage(image, memory);
+		throw std::runtime_error("Failed to bind image memory: "s + string_VkResult(rs));
 	}
-	vkBindImageMemory(ldev, image, memory, 0);
 	return pair(image, memory);
 }
 
+void RendererVk::freeImage(VkImage image, const MemoryAllocator::Allocation& memory) const {
+	vkDestroyImage(ldev, image, nullptr);
+	allocator.free(memory);
+}
+
 VkImageView RendererVk::createImageView(VkImage image, VkImageViewType type, VkFormat format) const {
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -1252,7 +1597,7 @@ VkFramebuffer RendererVk::createFramebuffer(VkRenderPass rpass, VkImageView view
 	return framebuffer;
 }
 
-pair<VkBuffer, VkDeviceMemory> RendererVk::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) const {
+pair<VkBuffer, MemoryAllocator::Allocation> RendererVk::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) const {
 	VkBufferCreateInfo bufferInfo{};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bufferInfo.size = size;
@@ -1266,24 +1611,25 @@ pair<VkBuffer, VkDeviceMemory> RendererVk::createBuffer(VkDeviceSize size, VkBuf
 	VkMemoryRequirements memRequirements;
 	vkGetBufferMemoryRequirements(ldev, buffer, &memRequirements);
 
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-	VkDeviceMemory memory;
-	if (VkResult rs = vkAllocateMemory(ldev, &allocInfo, nullptr, &memory); rs != VK_SUCCESS) {
+	MemoryAllocator::Allocation memory;
+	try {
+		memory = allocator.allocate(findMemoryType(memRequirements.memoryTypeBits, properties), memRequirements, true);
+	} catch (const std::runtime_error&) {
 		vkDestroyBuffer(ldev, buffer, nullptr);
-		throw std::runtime_error("Failed to allocate buffer memory: "s + string_VkResult(rs));
+		throw;
 	}
-	if (VkResult rs = vkBindBufferMemory(ldev, buffer, memory, 0); rs != VK_SUCCESS) {
-		vkDestroyBuffer(ldev, buffer, nullptr);
-		vkFreeMemory(ldev, memory, nullptr);
+	if (VkResult rs = vkBindBufferMemory(ldev, buffer, memory.memory, memory.offset); rs != VK_SUCCESS) {
+		freeBuffer(buffer, memory);
 		throw std::runtime_error("Failed to bind buffer memory: "s + string_VkResult(rs));
 	}
 	return pair(buffer, memory);
 }
 
+void RendererVk::freeBuffer(VkBuffer buffer, const MemoryAllocator::Allocation& memory) const {
+	vkDestroyBuffer(ldev, buffer, nullptr);
+	allocator.free(memory);
+}
+
 uint32 RendererVk::findMemoryType(uint32 typeFilter, VkMemoryPropertyFlags properties) const {
 	for (uint32 i = 0; i < pdevMemProperties.memoryTypeCount; ++i)
 		if ((typeFilter & (1 << i)) && (pdevMemProperties.memoryTypes[i].propertyFlags & properties) == properties)
@@ -1427,11 +1773,12 @@ void RendererVk::transitionImageLayout(VkCommandBuffer commandBuffer, VkImage im
 	vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 }
 
-void RendererVk::copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, u32vec2 size, uint32 pitch) {
+void RendererVk::copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, u32vec2 size, uint32 pitch, ivec2 offset) {
 	VkBufferImageCopy region{};
 	region.bufferRowLength = pitch;
 	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	region.imageSubresource.layerCount = 1;
+	region.imageOffset = { offset.x, offset.y, 0 };
 	region.imageExtent = { size.x, size.y, 1 };
 	vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 }
@@ -3,9 +3,68 @@
 #ifdef WITH_VULKAN
 #include "renderer.h"
 #include <vulkan/vulkan.h>
+#include <map>
 
 class RendererVk;
 
+// sub-allocates images and buffers from large device memory blocks
+class MemoryAllocator {
+public:
+	struct Allocation {
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		uint8* mapped = nullptr;	// points into the persistently mapped block if host visible
+		uint32 type = 0;
+	};
+
+	struct Stats {
+		VkDeviceSize reserved = 0;	// total size of all blocks
+		VkDeviceSize used = 0;		// total size of all live allocations
+		uint32 blocks = 0;
+		uint32 allocations = 0;
+	};
+
+private:
+	static constexpr VkDeviceSize deviceBlockSize = 64 * 1024 * 1024;
+	static constexpr VkDeviceSize hostBlockSize = 16 * 1024 * 1024;
+	static constexpr VkDeviceSize smallHeapFraction = 8;	// block size limit relative to the heap size
+
+	struct Range {
+		VkDeviceSize size;
+		bool linear;	// buffer or image with linear tiling
+	};
+
+	struct Block {
+		VkDeviceMemory memory;
+		VkDeviceSize size;
+		uint8* mapped;
+		std::map<VkDeviceSize, VkDeviceSize> free;	// offset to size of unused ranges
+		std::map<VkDeviceSize, Range> used;			// offset to live allocation
+
+		Block(VkDeviceMemory mem, VkDeviceSize bsize, uint8* data);
+
+		optional<VkDeviceSize> place(const VkMemoryRequirements& req, bool linear, VkDeviceSize granularity);
+		void release(VkDeviceSize offset);
+	};
+
+	VkDevice dev = VK_NULL_HANDLE;
+	VkDeviceSize granularity = 1;
+	VkPhysicalDeviceMemoryProperties memProperties{};
+	vector<vector<Block>> pools;	// blocks per memory type
+
+public:
+	void init(VkDevice device, const VkPhysicalDeviceProperties& prop, const VkPhysicalDeviceMemoryProperties& memp);
+	Allocation allocate(uint32 type, const VkMemoryRequirements& req, bool linear);
+	void free(const Allocation& alc);
+	void free();
+	Stats getStats(VkMemoryPropertyFlags properties) const;
+
+private:
+	Block& createBlock(uint32 type, VkDeviceSize minSize);
+	VkDeviceSize blockSize(uint32 type) const;
+};
+
 class GenericPass {
 protected:
 	VkRenderPass handle = VK_NULL_HANDLE;
@@ -73,7 +132,7 @@ public:
 private:
 	void createRenderPass(VkDevice dev, VkFormat format);
 	void createDescriptorSetLayout(VkDevice dev);
-	void createPipeline(VkDevice dev);
+	void createPipeline(VkDevice dev, VkPipelineCache cache);
 	vector<VkDescriptorSet> createDescriptorPoolAndSets(VkDevice dev, uint32 numViews);
 };
 
@@ -97,12 +156,12 @@ private:
 	VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
 	VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
 	VkBuffer uniformBuffer = VK_NULL_HANDLE;
-	VkDeviceMemory uniformBufferMemory = VK_NULL_HANDLE;
+	MemoryAllocator::Allocation uniformBufferMemory;
 	UniformData* uniformBufferMapped;
 
 public:
 	void init(const RendererVk* rend);
-	void free(VkDevice dev);
+	void free(const RendererVk* rend);
 
 	VkDescriptorSet getDescriptorSet() const;
 	UniformData* getUniformBufferMapped() const;
@@ -110,7 +169,7 @@ public:
 private:
 	void createRenderPass(VkDevice dev);
 	void createDescriptorSetLayout(VkDevice dev);
-	void createPipeline(VkDevice dev);
+	void createPipeline(VkDevice dev, VkPipelineCache cache);
 	void createUniformBuffer(const RendererVk* rend);
 	void createDescriptorPoolAndSet(VkDevice dev);
 	void updateDescriptorSet(VkDevice dev);
@@ -131,17 +190,33 @@ private:
 #ifndef NDEBUG
 	static constexpr array<const char*, 1> validationLayers = { "VK_LAYER_KHRONOS_validation" };
 #endif
+	static constexpr char filePipelineCache[] = "pipeline_cache_vk.dat";
+	static constexpr uint32 pipelineCacheMagic = 0x43505256;	// "VRPC"
+	static constexpr uint32 timerQuerySelect = 0;	// timestamp pairs in the query pool, followed by one pair per view and frame for drawing
+	static constexpr uint32 timerQueryUpload = 2;
+	static constexpr uint32 timerQueryDraw = 4;
+
+	// prepended to the driver's cache data to tell whether it belongs to the current device and driver
+	struct PipelineCacheHeader {
+		uint32 magic;
+		uint32 vendorID;
+		uint32 deviceID;
+		uint32 driverVersion;
+		array<uint8, VK_UUID_SIZE> uuid;
+		uint64 dataSize;
+		uint64 checksum;
+	};
 
 	class TextureVk : public Texture {
 	private:
 		VkImage image;
-		VkDeviceMemory memory;
+		MemoryAllocator::Allocation memory;
 		VkImageView view;
 		VkDescriptorPool pool;
 		VkDescriptorSet set;
 		uint sid;
 
-		TextureVk(ivec2 size, VkImage img, VkDeviceMemory mem, VkImageView imageView, VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet, uint samplerId);
+		TextureVk(ivec2 size, VkImage img, const MemoryAllocator::Allocation& mem, VkImageView imageView, VkDescriptorPool descriptorPool, VkDescriptorSet descriptorSet, uint samplerId);
 
 		friend class RendererVk;
 	};
@@ -158,13 +233,15 @@ private:
 
 		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
 		VkBuffer uniformBuffer = VK_NULL_HANDLE;
-		VkDeviceMemory uniformMemory = VK_NULL_HANDLE;
+		MemoryAllocator::Allocation uniformMemory;
 		RenderPass::UniformData* uniformMapped;
 
 		array<VkCommandBuffer, maxFrames> commandBuffers{};
 		array<VkSemaphore, maxFrames> imageAvailableSemaphores{};
 		array<VkSemaphore, maxFrames> renderFinishedSemaphores{};
 		array<VkFence, maxFrames> frameFences{};
+		array<bool, maxFrames> timed{};	// whether the frame's draw timestamps are waiting to be read
+		uint32 timerIndex = 0;
 
 		using View::View;
 	};
@@ -179,19 +256,25 @@ private:
 	VkDebugUtilsMessengerEXT dbgMessenger = VK_NULL_HANDLE;
 #endif
 	VkFence singleTimeFence = VK_NULL_HANDLE;
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+	fs::path pipelineCachePath;
 	uint32 gfamilyIndex, pfamilyIndex;
 	RenderPass renderPass;
 	AddressPass addressPass;
+	mutable MemoryAllocator allocator;
 
 	VkImage addrImage = VK_NULL_HANDLE;
-	VkDeviceMemory addrImageMemory = VK_NULL_HANDLE;
+	MemoryAllocator::Allocation addrImageMemory;
 	VkImageView addrView = VK_NULL_HANDLE;
 	VkFramebuffer addrFramebuffer = VK_NULL_HANDLE;
 	VkBuffer addrBuffer = VK_NULL_HANDLE;
-	VkDeviceMemory addrBufferMemory = VK_NULL_HANDLE;
+	MemoryAllocator::Allocation addrBufferMemory;
 	u32vec2* addrMappedMemory;
 	VkCommandBuffer commandBufferAddr = VK_NULL_HANDLE;
 	VkFence addrFence = VK_NULL_HANDLE;
+	VkQueryPool timerPool = VK_NULL_HANDLE;	// null if timestamps aren't supported
+	uint64 timestampMask;
+	GpuTimes timerSums;	// accumulated until the next frame's draw times are read
 
 	VkPhysicalDeviceProperties pdevProperties;
 	VkPhysicalDeviceMemoryProperties pdevMemProperties;
@@ -203,7 +286,7 @@ private:
 	bool refreshFramebuffer = false;
 
 public:
-	RendererVk(const umap<int, SDL_Window*>& windows, Settings* sets, ivec2& viewRes, ivec2 origin, const vec4& bgcolor);
+	RendererVk(const umap<int, SDL_Window*>& windows, Settings* sets, const fs::path& dirSets, ivec2& viewRes, ivec2 origin, const vec4& bgcolor);
 	~RendererVk() final;
 
 	void setClearColor(const vec4& color) final;
@@ -220,15 +303,21 @@ public:
 	void drawSelRect(const Widget* wgt, const Recti& rect, const Recti& frame) final;
 	Widget* finishSelDraw(View* view) final;
 
-	Texture* texFromImg(SDL_Surface* img) final;
+	Texture* texFromImg(SDL_Surface* img, Texture::Owner owner) final;
 	Texture* texFromText(SDL_Surface* img) final;
+	void updateText(Texture* tex, const SDL_Surface* img, const Recti& area) final;
 	void freeTexture(Texture* tex) final;
+	uptrt deviceMemory() const final;
 
 	VkDevice getLogicalDevice() const;
-	pair<VkImage, VkDeviceMemory> createImage(u32vec2 size, VkImageType type, VkFormat format, VkImageUsageFlags usage, VkMemoryPropertyFlags properties) const;
+	VkPipelineCache getPipelineCache() const;
+	pair<VkImage, MemoryAllocator::Allocation> createImage(u32vec2 size, VkImageType type, VkFormat format, VkImageUsageFlags usage, VkMemoryPropertyFlags properties) const;
+	void freeImage(VkImage image, const MemoryAllocator::Allocation& memory) const;
 	VkImageView createImageView(VkImage image, VkImageViewType type, VkFormat format) const;
 	VkFramebuffer createFramebuffer(VkRenderPass rpass, VkImageView view, u32vec2 size) const;
-	pair<VkBuffer, VkDeviceMemory> createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) const;
+	pair<VkBuffer, MemoryAllocator::Allocation> createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) const;
+	void freeBuffer(VkBuffer buffer, const MemoryAllocator::Allocation& memory) const;
+	MemoryAllocator::Stats getMemoryStats(VkMemoryPropertyFlags properties) const;
 	uint32 findMemoryType(uint32 typeFilter, VkMemoryPropertyFlags properties) const;
 	void allocateCommandBuffers(VkCommandBuffer* cmdBuffers, uint32 count) const;
 	void freeCommandBuffers(VkCommandBuffer* cmdBuffers, uint32 count) const;
@@ -240,7 +329,7 @@ public:
 	void endSingleTimeCommands(VkCommandBuffer commandBuffer) const;
 	void submitSingleTimeCommands(VkCommandBuffer commandBuffer) const;
 	template <VkImageLayout srcLay, VkImageLayout dstLay> static void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image);
-	static void copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, u32vec2 size, uint32 pitch);
+	static void copyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, u32vec2 size, uint32 pitch, ivec2 offset = ivec2(0));
 	static void copyImageToBuffer(VkCommandBuffer commandBuffer, VkImage image, VkBuffer buffer, u32vec2 size);
 
 private:
@@ -248,12 +337,20 @@ private:
 	void pickPhysicalDevice(u32vec2& preferred);
 	void createDevice();
 	void createCommandPool();
+	void createPipelineCache();
+	void createTimerPool();
+	void savePipelineCache() const;
+	PipelineCacheHeader makePipelineCacheHeader(const uint8* data, sizet size) const;
 	VkFormat createSwapchain(ViewVk* view, VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
 	void freeFramebuffers(ViewVk* view);
 	void recreateSwapchain(ViewVk* view);
 	void createFramebuffers(ViewVk* view);
 	void createUniformBuffer(ViewVk* view);
 	void setPresentMode(bool vsync);
+	uint32 drawTimerQuery(const ViewVk* view) const;
+	void beginTimer(VkCommandBuffer commandBuffer, uint32 query) const;
+	void endTimer(VkCommandBuffer commandBuffer, uint32 query) const;
+	float readTimer(uint32 query) const;
 
 #ifdef NDEBUG
 	static vector<const char*> getRequiredExtensions(SDL_Window* win);
@@ -278,6 +375,14 @@ inline VkDevice RendererVk::getLogicalDevice() const {
 	return ldev;
 }
 
+inline VkPipelineCache RendererVk::getPipelineCache() const {
+	return pipelineCache;
+}
+
+inline MemoryAllocator::Stats RendererVk::getMemoryStats(VkMemoryPropertyFlags properties) const {
+	return allocator.getStats(properties);
+}
+
 inline void RendererVk::freeCommandBuffers(VkCommandBuffer* cmdBuffers, uint32 count) const {
 	vkFreeCommandBuffers(ldev, cmdPool, count, cmdBuffers);
 }
@@ -23,27 +23,46 @@ Scene::~Scene() {
 }
 
 void Scene::tick(float dSec) {
-	layout->tick(dSec);
-	if (popup)
-		popup->tick(dSec);
-	if (overlay)
-		overlay->tick(dSec);
-	if (context)
-		context->tick(dSec);
+	if (!tickers.empty()) {
+		tickQueue.assign(tickers.begin(), tickers.end());	// widgets unsubscribe themselves when they're done
+		for (Widget* it : tickQueue)
+			it->tick(dSec);
+	}
 }
 
 void Scene::onMouseMove(ivec2 mPos, ivec2 mMov) {
+	// only the widgets affected by the cursor need to be redrawn
+	DrawSys* drawSys = World::drawSys();
+	Widget* last = select;
+	bool overlayOn = overlay && overlay->on;
 	updateSelect(mPos);
+	if (select != last) {
+		if (last)
+			drawSys->invalidate(last);
+		if (select)
+			drawSys->invalidate(select);
+	}
+	if (overlay && overlay->on != overlayOn)
+		drawSys->invalidate();
+	drawSys->invalidateTooltip(dynamic_cast<Button*>(select));
 	if (capture)
 		capture->onDrag(mPos, mMov);
 
-	layout->onMouseMove(mPos, mMov);
-	if (popup)
-		popup->onMouseMove(mPos, mMov);
-	if (overlay)
-		overlay->onMouseMove(mPos, mMov);
-	if (context)
-		context->onMouseMove(mPos, mMov);
+	// only the hovered widgets, the one that was just left and the subscribers need to know about the movement
+	for (Widget* it : mouseHooks)
+		it->onMouseMove(mPos, mMov);
+	sendMouseMove(select, mPos, mMov);
+	if (last != select && last && !mouseHooks.count(last))
+		last->onMouseMove(mPos, mMov);
+}
+
+void Scene::sendMouseMove(Widget* wgt, ivec2 mPos, ivec2 mMov) {
+	for (; wgt; wgt = wgt->getParent()) {
+		if (!mouseHooks.count(wgt))
+			wgt->onMouseMove(mPos, mMov);
+		if (wgt == layout || wgt == popup || wgt == overlay || wgt == context)
+			break;
+	}
 }
 
 void Scene::onMouseDown(ivec2 mPos, uint8 mBut, uint8 mCnt) {
@@ -93,6 +112,7 @@ void Scene::onCompose(string_view str) {
 	if (capture) {
 		capture->onCompose(str, captureLen);
 		captureLen = str.length();
+		World::drawSys()->invalidate(capture);
 	}
 }
 
@@ -100,6 +120,7 @@ void Scene::onText(string_view str) {
 	if (capture) {
 		capture->onText(str, captureLen);
 		captureLen = 0;
+		World::drawSys()->invalidate(capture);
 	}
 }
 
@@ -140,11 +161,15 @@ void Scene::clearLayouts() {
 	delete overlay;
 	delete context;
 	context = nullptr;
+	arena.clear();
 }
 
 void Scene::setLayouts() {
-	layout = World::state()->createLayout();
-	overlay = World::state()->createOverlay();
+	{
+		WidgetArena::Scope scope(arena);
+		layout = World::state()->createLayout();
+		overlay = World::state()->createOverlay();
+	}
 	layout->postInit();
 	if (overlay)
 		overlay->postInit();
@@ -204,7 +229,7 @@ Widget* Scene::getSelected(ivec2 mPos) {
 
 	for (;;) {
 		Recti frame = box->frame();
-		if (vector<Widget*>::const_iterator it = std::find_if(box->getWidgets().begin(), box->getWidgets().end(), [&frame, &mPos](const Widget* wi) -> bool { return wi->rect().intersect(frame).contains(mPos); }); it != box->getWidgets().end()) {
+		if (vector<Widget*>::const_iterator it = std::find_if(box->getWidgets().begin(), box->getWidgets().end(), [&frame, &mPos](const Widget* wi) -> bool { return wi && wi->rect().intersect(frame).contains(mPos); }); it != box->getWidgets().end()) {
 			if (Layout* lay = dynamic_cast<Layout*>(*it))
 				box = lay;
 			else
@@ -242,10 +267,10 @@ void Scene::selectFirst() {
 			if (id >= lay->getWidgets().size()) {
 				id = lay->getIndex() + 1;
 				lay = lay->getParent();
-			} else if (next = dynamic_cast<Layout*>(lay->getWidget(id)); next)
+			} else if (next = dynamic_cast<Layout*>(lay->loadWidget(id)); next)
 				lay = next;
 			else if (lay->getWidget(id)->navSelectable()) {
-				select = lay->getWidget(0);
+				select = lay->loadWidget(0);
 				break;
 			} else
 				++id;
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "utils/utils.h"
+#include "utils/widgets.h"
 
 // saves what widget is being clicked on with what button at what position
 struct ClickStamp {
@@ -21,6 +21,10 @@ private:
 	Popup* popup = nullptr;
 	Overlay* overlay = nullptr;
 	Context* context = nullptr;
+	uset<Widget*> tickers;		// widgets with time based behavior
+	uset<Widget*> mouseHooks;	// widgets that want every mouse movement, not just the ones over them
+	vector<Widget*> tickQueue;	// copy of tickers to iterate over while they're changing
+	WidgetArena arena;			// holds the layout's and overlay's widgets
 	array<ClickStamp, SDL_BUTTON_RIGHT> stamps;	// data about last mouse click (indexes are mouse button numbers
 	uint captureLen = 0;	// composing substring length
 
@@ -53,6 +57,10 @@ public:
 	void setPopup(pair<Popup*, Widget*> popcap);
 	Context* getContext();
 	void setContext(Context* newContext);
+	void subscribeTick(Widget* wgt);
+	void unsubscribeTick(Widget* wgt);
+	void subscribeMouseMove(Widget* wgt);
+	void unsubscribe(Widget* wgt);
 
 	void updateSelect();
 	void updateSelect(ivec2 mPos);
@@ -63,6 +71,7 @@ public:
 	ScrollArea* getSelectedScrollArea() const;
 private:
 	Widget* getSelected(ivec2 mPos);
+	void sendMouseMove(Widget* wgt, ivec2 mPos, ivec2 mMov);
 	bool overlayFocused(ivec2 mPos) const;
 };
 
@@ -90,6 +99,23 @@ inline Context* Scene::getContext() {
 	return context;
 }
 
+inline void Scene::subscribeTick(Widget* wgt) {
+	tickers.insert(wgt);
+}
+
+inline void Scene::unsubscribeTick(Widget* wgt) {
+	tickers.erase(wgt);
+}
+
+inline void Scene::subscribeMouseMove(Widget* wgt) {
+	mouseHooks.insert(wgt);
+}
+
+inline void Scene::unsubscribe(Widget* wgt) {
+	tickers.erase(wgt);
+	mouseHooks.erase(wgt);
+}
+
 inline void Scene::updateSelect(ivec2 mPos) {
 	select = getSelected(mPos);
 }
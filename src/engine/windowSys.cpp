@@ -2,25 +2,66 @@
 #include "drawSys.h"
 #include "fileSys.h"
 #include "inputSys.h"
+#include "inputTrace.h"
+#include "memoryGovernor.h"
 #include "scene.h"
+#include "world.h"
 #include "prog/program.h"
 #include "prog/progs.h"
+#include "utils/trace.h"
 #ifdef _WIN32
 #include <SDL_image.h>
 #else
 #include <SDL2/SDL_image.h>
 #endif
 
-int WindowSys::start() {
+// FRAME STATS
+
+void FrameStats::finishFrame(uint64 now) {
+	current.interval = lastFrame ? float(now - lastFrame) * msPerTick : 0.f;
+	lastFrame = now;
+	history[next] = current;
+	next = (next + 1) % historyLength;
+	current = Frame();
+}
+
+FrameStats::Frame FrameStats::average() const {
+	Frame avg;
+	for (const Frame& it : history) {
+		avg.interval += it.interval;
+		for (sizet i = 0; i < avg.phases.size(); ++i)
+			avg.phases[i] += it.phases[i];
+	}
+	avg.interval /= float(historyLength);
+	for (float& it : avg.phases)
+		it /= float(historyLength);
+	return avg;
+}
+
+float FrameStats::maxInterval() const {
+	return std::max_element(history.begin(), history.end(), [](const Frame& a, const Frame& b) -> bool { return a.interval < b.interval; })->interval;
+}
+
+// WINDOW SYS
+
+int WindowSys::start(const std::function<void()>& body) {
 	fileSys = nullptr;
 	inputSys = nullptr;
+	inputTrace = nullptr;
+	memGovernor = nullptr;
 	program = nullptr;
 	scene = nullptr;
 	sets = nullptr;
 	int rc = EXIT_SUCCESS;
 	try {
 		init();
-		exec();
+		if (body)
+			body();
+		else if (const string* book = World::getOpt("bench-open")) {
+			const string* repeat = World::getOpt("repeat");
+			benchOpen(fs::u8path(*book), repeat ? std::max(toNum<uint>(*repeat), 1u) : 1);
+		} else
+			exec();
 	} catch (const std::runtime_error& e) {
 		logError(e.what());
 		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", e.what(), !windows.empty() ? windows.begin()->second : nullptr);
@@ -35,9 +76,13 @@ int WindowSys::start() {
 	delete program;
 	delete scene;
 	delete inputSys;
+	delete inputTrace;
+	delete memGovernor;
 	destroyWindows();
 	delete fileSys;
 	delete sets;
+	if (const string* trace = World::getOpt("trace"))
+		Trace::write(fs::u8path(*trace));
 
 	IMG_Quit();
 	TTF_Quit();
@@ -46,6 +91,12 @@ int WindowSys::start() {
 }
 
 void WindowSys::init() {
+	if (const string* rnd = World::getOpt("renderer"))
+		rendererOverride = strToEnum<Settings::Renderer>(Settings::rendererNames, *rnd);
+	if (headless = World::hasFlag("headless") || rendererOverride == Settings::Renderer::null || World::getOpt("replay"); headless) {
+		rendererOverride = Settings::Renderer::null;
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+	}
 #if SDL_VERSION_ATLEAST(2, 0, 22)
 	SDL_SetHint(SDL_HINT_IME_SUPPORT_EXTENDED_TEXT, "1");
 #endif
@@ -62,6 +113,8 @@ void WindowSys::init() {
 	SDL_SetHint(SDL_HINT_IME_SHOW_UI, "1");
 	SDL_SetHint(SDL_HINT_MOUSE_FOCUS_CLICKTHROUGH, "1");
 	SDL_SetHint(SDL_HINT_MAC_CTRL_CLICK_EMULATE_RIGHT_CLICK, "1");
+	if (World::getOpt("trace"))
+		Trace::start();
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER))
 		throw std::runtime_error(SDL_GetError());
 	if (TTF_Init())
@@ -125,7 +178,13 @@ void WindowSys::init() {
 		throw std::runtime_error(SDL_GetError());
 	SDL_StopTextInput();
 
-	fileSys = new FileSys;
+	if (const string* file = World::getOpt("replay"))
+		inputTrace = new InputTrace(fs::u8path(*file), true);
+	else if (const string* rec = World::getOpt("record"))
+		inputTrace = new InputTrace(fs::u8path(*rec), false);
+	const string* setsDir = World::getOpt("settings");
+	fileSys = new FileSys(setsDir ? fs::u8path(*setsDir) : fs::path(), headless);
+	memGovernor = new MemoryGovernor;
 	sets = fileSys->loadSettings();
 	createWindow();
 	inputSys = new InputSys;
@@ -138,27 +197,115 @@ void WindowSys::init() {
 }
 
 void WindowSys::exec() {
-	for (uint32 oldTime = SDL_GetTicks(); run;) {
+	if (inputTrace)
+		inputTrace->start(windows.size() == 1 ? SDL_GetWindowID(windows.begin()->second) : 0);
+	for (uint32 oldTime = SDL_GetTicks(), drawTime = 0; run;) {
 		uint32 newTime = SDL_GetTicks();
 		dSec = float(newTime - oldTime) / ticksPerSec;
 		oldTime = newTime;
 
-		drawSys->drawWidgets(scene, inputSys->mouseWin.has_value());
+		if (drawSys->needsRedraw() && windowsVisible() && (!sets->maxFps || SDL_TICKS_PASSED(newTime, drawTime + uint32(ticksPerSec) / sets->maxFps))) {
+			if (showStats) {
+				frameStats.loaderQueue = std::max(SDL_PeepEvents(nullptr, 0, SDL_PEEKEVENT, SDL_USEREVENT_READER_PROGRESS, SDL_USEREVENT_READER_PROGRESS), 0);
+				frameStats.previewQueue = std::max(SDL_PeepEvents(nullptr, 0, SDL_PEEKEVENT, SDL_USEREVENT_PREVIEW_PROGRESS, SDL_USEREVENT_PREVIEW_PROGRESS), 0);
+			}
+			uint64 start = SDL_GetPerformanceCounter();
+			drawSys->drawWidgets(scene, inputSys->mouseWin.has_value(), showStats ? &frameStats : nullptr);
+			uint64 end = SDL_GetPerformanceCounter();
+			frameStats.add(FrameStats::Phase::draw, end - start - drawSys->getPresentTicks());
+			frameStats.add(FrameStats::Phase::present, drawSys->getPresentTicks());
+			frameStats.finishFrame(end);
+			if (inputTrace)
+				inputTrace->addFrame(end - start);
+			drawTime = newTime;
+			program->eventTextureResidency();
+		}
+		uint64 start = SDL_GetPerformanceCounter();
 		inputSys->tick();
+		uint64 mid = SDL_GetPerformanceCounter();
 		scene->tick(dSec);
+		frameStats.add(FrameStats::Phase::input, mid - start);
+		frameStats.add(FrameStats::Phase::tick, SDL_GetPerformanceCounter() - mid);
+		if (memGovernor->update())
+			program->eventMemoryPressure();
+
+		// recorded input goes through the same handler once it's due and the replay ends after everything has settled
+		if (inputTrace && inputTrace->isReplaying()) {
+			for (SDL_Event event; inputTrace->nextEvent(event);)
+				handleEvent(event);
+			if (inputTrace->waiting() && !program->busy())	// nothing is running that could get there
+				inputTrace->skipWait();
+			if (inputTrace->finished() && !program->busy() && !(drawSys->needsRedraw() && windowsVisible())) {
+				close();
+				continue;
+			}
+		}
 
+		// sleep until the next event when there's nothing to draw
 		SDL_Event event;
+		if (!SDL_WaitEventTimeout(&event, eventWaitTime(drawTime)))
+			continue;
+		start = SDL_GetPerformanceCounter();
 		uint32 timeout = SDL_GetTicks() + eventCheckTimeout;
 		do {
-			if (!SDL_PollEvent(&event))
-				break;
 			handleEvent(event);
-		} while (!SDL_TICKS_PASSED(SDL_GetTicks(), timeout));
+		} while (!SDL_TICKS_PASSED(SDL_GetTicks(), timeout) && SDL_PollEvent(&event));
+		frameStats.add(FrameStats::Phase::events, SDL_GetPerformanceCounter() - start);
 	}
 	fileSys->saveSettings(sets);
 	fileSys->saveBindings(inputSys->getBindings());
 }
 
+// opens a book with and without its files in the page cache and logs how long it took until the reader could be shown
+void WindowSys::benchOpen(const fs::path& book, uint repeat) {
+	fs::path file = book;
+	if (fs::is_directory(book)) {	// start at the first picture so that the reader gets opened instead of the browser
+		vector<fs::path> files = FileSys::listDir(book, true, false, sets->showHidden);
+		vector<fs::path>::iterator it = std::find_if(files.begin(), files.end(), [&book](const fs::path& fi) -> bool { return FileSys::isPicture(book / fi); });
+		if (it == files.end())
+			throw std::runtime_error("No pictures in " + book.u8string());
+		file = book / *it;
+	}
+	fs::path cached = FileSys::isPicture(file) ? parentPath(file) : file;
+	double msPerTick = 1000.0 / double(SDL_GetPerformanceFrequency());
+	array<vector<double>, 2> firstTimes, fullTimes;	// cold and warm
+
+	for (uint i = 0; i < repeat; ++i)
+		for (bool cold : { true, false }) {
+			program->eventOpenBookList();
+			if (cold && !FileSys::dropCache(cached) && !i)
+				logError("Can't drop files from the page cache on this system, cold runs won't be cold");
+			resetPeakMemory();
+
+			uint64 start = SDL_GetPerformanceCounter();
+			if (!program->openFile(file) || !program->busy())
+				throw std::runtime_error("Failed to open " + file.u8string() + " in the reader");
+			double first = 0.0;
+			uint progress = 0;
+			for (SDL_Event event; program->busy();)
+				if (SDL_WaitEventTimeout(&event, eventCheckTimeout)) {
+					if (event.type == SDL_USEREVENT_READER_PROGRESS && ++progress == 2)	// reported before each picture, so this is after the first one
+						first = double(SDL_GetPerformanceCounter() - start) * msPerTick;
+					handleEvent(event);
+				}
+			drawSys->drawWidgets(scene, false, nullptr);
+			double full = double(SDL_GetPerformanceCounter() - start) * msPerTick;
+			if (first == 0.0)
+				first = full;
+
+			ProgReader* reader = dynamic_cast<ProgReader*>(program->getState());
+			firstTimes[!cold].push_back(first);
+			fullTimes[!cold].push_back(full);
+			logInfo("Open ", cold ? "cold " : "warm ", i + 1, '/', repeat, ": first page ", toStr(first), " ms, full batch ", toStr(full), " ms, ", reader ? reader->reader->getWidgets().size() : 0, " pages, peak memory ", toStr(double(peakMemory()) / 1'000'000.0), " MB");
+		}
+
+	for (sizet i = 0; i < firstTimes.size(); ++i) {
+		std::sort(firstTimes[i].begin(), firstTimes[i].end());
+		std::sort(fullTimes[i].begin(), fullTimes[i].end());
+		logInfo("Open ", i ? "warm" : "cold", " median: first page ", toStr(firstTimes[i][repeat / 2]), " ms, full batch ", toStr(fullTimes[i][repeat / 2]), " ms");
+	}
+}
+
 void WindowSys::createWindow() {
 	if (sets->screen == Settings::Screen::multiFullscreen && sets->displays.empty())
 		sets->screen = Settings::Screen::fullscreen;
@@ -168,9 +315,17 @@ void WindowSys::createWindow() {
 	else
 		flags |= SDL_WINDOW_FULLSCREEN_DESKTOP | SDL_WINDOW_SKIP_TASKBAR;
 	SDL_Surface* icon = IMG_Load((fileSys->dirIcons() / "vertiread.svg").u8string().c_str());
+	if (getRenderer() == Settings::Renderer::null) {
+		if (sets->screen != Settings::Screen::multiFullscreen)
+			createSingleWindow(flags, icon);
+		else
+			createMultiWindow(flags, icon);
+		SDL_FreeSurface(icon);
+		return;
+	}
 
-	array<pair<Settings::Renderer, uint32>, sizet(Settings::Renderer::max)> renderers;
-	switch (sets->renderer) {
+	array<pair<Settings::Renderer, uint32>, sizet(Settings::Renderer::null)> renderers;
+	switch (getRenderer()) {
 #ifdef WITH_DIRECTX
 	case Settings::Renderer::directx:
 		renderers = {
@@ -179,8 +334,9 @@ void WindowSys::createWindow() {
 			pair(Settings::Renderer::opengl, SDL_WINDOW_OPENGL),
 #endif
 #ifdef WITH_VULKAN
-			pair(Settings::Renderer::vulkan, SDL_WINDOW_VULKAN)
+			pair(Settings::Renderer::vulkan, SDL_WINDOW_VULKAN),
 #endif
+			pair(Settings::Renderer::software, 0)
 		};
 		break;
 #endif
@@ -192,8 +348,9 @@ void WindowSys::createWindow() {
 			pair(Settings::Renderer::directx, 0),
 #endif
 #ifdef WITH_VULKAN
-			pair(Settings::Renderer::vulkan, SDL_WINDOW_VULKAN)
+			pair(Settings::Renderer::vulkan, SDL_WINDOW_VULKAN),
 #endif
+			pair(Settings::Renderer::software, 0)
 		};
 		break;
 #endif
@@ -205,14 +362,29 @@ void WindowSys::createWindow() {
 			pair(Settings::Renderer::opengl, SDL_WINDOW_OPENGL),
 #endif
 #ifdef WITH_DIRECTX
-			pair(Settings::Renderer::directx, 0)
+			pair(Settings::Renderer::directx, 0),
 #endif
+			pair(Settings::Renderer::software, 0)
 		};
+		break;
+#endif
+	case Settings::Renderer::software:
+		renderers = {
+			pair(Settings::Renderer::software, 0),
+#ifdef WITH_OPENGL
+			pair(Settings::Renderer::opengl, SDL_WINDOW_OPENGL),
+#endif
+#ifdef WITH_DIRECTX
+			pair(Settings::Renderer::directx, 0),
+#endif
+#ifdef WITH_VULKAN
+			pair(Settings::Renderer::vulkan, SDL_WINDOW_VULKAN)
 #endif
+		};
 	}
 	for (auto [rnd, rfl] : renderers) {
 		try {
-			sets->renderer = rnd;
+			(rendererOverride != Settings::Renderer::max ? rendererOverride : sets->renderer) = rnd;
 			if (sets->screen != Settings::Screen::multiFullscreen)
 				createSingleWindow(flags | rfl, icon);
 			else
@@ -237,7 +409,7 @@ void WindowSys::createSingleWindow(uint32 flags, SDL_Surface* icon) {
 		throw std::runtime_error("Failed to create window:"s + linend + SDL_GetError());
 	windows.emplace(Renderer::singleDspId, win);
 
-	drawSys = new DrawSys(windows, sets, fileSys, int(128.f / fallbackDpi * winDpi));
+	drawSys = new DrawSys(windows, getRenderer(), sets, fileSys, int(128.f / fallbackDpi * winDpi));
 	SDL_SetWindowIcon(win, icon);
 	SDL_SetWindowMinimumSize(win, windowMinSize.x, windowMinSize.y);
 	if (SDL_GetDisplayDPI(SDL_GetWindowDisplayIndex(windows.begin()->second), nullptr, nullptr, &winDpi))
@@ -255,7 +427,7 @@ void WindowSys::createMultiWindow(uint32 flags, SDL_Surface* icon) {
 		SDL_SetWindowIcon(win, icon);
 	}
 
-	drawSys = new DrawSys(windows, sets, fileSys, int(128.f / fallbackDpi * winDpi));
+	drawSys = new DrawSys(windows, getRenderer(), sets, fileSys, int(128.f / fallbackDpi * winDpi));
 	if (SDL_GetDisplayDPI(SDL_GetWindowDisplayIndex(windows.begin()->second), nullptr, nullptr, &winDpi))
 		winDpi = fallbackDpi;
 }
@@ -268,6 +440,20 @@ void WindowSys::destroyWindows() {
 	windows.clear();
 }
 
+bool WindowSys::windowsVisible() const {
+	return std::any_of(windows.begin(), windows.end(), [](const pair<const int, SDL_Window*>& it) -> bool { return !(SDL_GetWindowFlags(it.second) & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED)); });
+}
+
+uint32 WindowSys::eventWaitTime(uint32 drawTime) const {
+	uint32 wait = eventCheckTimeout;	// still wake up regularly for widget timers
+	if (drawSys->needsRedraw() && windowsVisible()) {
+		uint32 next = drawTime + (sets->maxFps ? uint32(ticksPerSec) / sets->maxFps : 0);
+		uint32 now = SDL_GetTicks();
+		wait = SDL_TICKS_PASSED(now, next) ? 0 : next - now;
+	}
+	return inputTrace && inputTrace->isReplaying() ? std::min(wait, inputTrace->waitTime()) : wait;
+}
+
 void WindowSys::recreateWindows() {
 	scene->clearLayouts();
 	destroyWindows();
@@ -276,10 +462,31 @@ void WindowSys::recreateWindows() {
 }
 
 void WindowSys::handleEvent(const SDL_Event& event) {
+	if (inputTrace) {
+		if (!inputTrace->isReplaying())
+			inputTrace->record(event);
+		else
+			inputTrace->reach(event.type);
+	}
+
+	switch (event.type) {
+	case SDL_MOUSEMOTION: case SDL_FINGERMOTION: case SDL_TEXTEDITING: case SDL_TEXTINPUT: case SDL_USEREVENT_READER_RELOADED: case SDL_USEREVENT_PREVIEW_PROGRESS:
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+	case SDL_TEXTEDITING_EXT:
+#endif
+		break;	// these report their own damage
+	default:
+		drawSys->invalidate();
+	}
+
 	switch (event.type) {
 	case SDL_QUIT:
 		program->eventTryExit();
 		break;
+	case SDL_APP_LOWMEMORY:
+		if (memGovernor->lowMemoryWarning())
+			program->eventMemoryPressure();
+		break;
 	case SDL_DISPLAYEVENT:
 		eventDisplay(event.display);
 		break;
@@ -354,6 +561,9 @@ void WindowSys::handleEvent(const SDL_Event& event) {
 	case SDL_USEREVENT_READER_FINISHED:
 		program->eventReaderFinished(event.user);
 		break;
+	case SDL_USEREVENT_READER_RELOADED:
+		program->eventReaderReloaded(event.user);
+		break;
 	case SDL_USEREVENT_PREVIEW_PROGRESS:
 		program->eventPreviewProgress(event.user);
 		break;
@@ -466,6 +676,11 @@ void WindowSys::toggleOpacity() {
 	}
 }
 
+void WindowSys::toggleFrameStats() {
+	showStats = !showStats;
+	drawSys->invalidate();
+}
+
 void WindowSys::setScreenMode(Settings::Screen sm) {
 	bool changeFlag = sets->screen != Settings::Screen::multiFullscreen && sm != Settings::Screen::multiFullscreen;
 	sets->screen = sm;
@@ -498,6 +713,14 @@ ivec2 WindowSys::displayResolution() const {
 	return res;
 }
 
+// picking one in the settings replaces the command line's choice, unless there's nothing to show it on
+void WindowSys::setRenderer(Settings::Renderer rnd) {
+	sets->renderer = rnd;
+	if (rendererOverride != Settings::Renderer::null)
+		rendererOverride = Settings::Renderer::max;
+	recreateWindows();
+}
+
 void WindowSys::resetSettings() {
 	delete sets;
 	sets = new Settings(fileSys->getDirSets(), fileSys->getAvailableThemes());
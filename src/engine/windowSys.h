@@ -1,6 +1,63 @@
 #pragma once
 
 #include "utils/settings.h"
+#include <functional>
+
+// rolling CPU timings of the main loop's phases, cheap enough to always be collected
+class FrameStats {
+public:
+	enum class Phase : uint8 {
+		draw,
+		present,
+		input,
+		tick,
+		events,
+		max
+	};
+	static constexpr array<const char*, sizet(Phase::max)> phaseNames = {
+		"draw",
+		"present",
+		"input",
+		"tick",
+		"events"
+	};
+	static constexpr sizet historyLength = 120;
+
+	struct Frame {
+		float interval = 0.f;	// milliseconds since the previous frame
+		array<float, sizet(Phase::max)> phases{};
+	};
+
+	uint loaderQueue = 0;	// pending results of the picture loader
+	uint previewQueue = 0;	// pending preview thumbnails
+private:
+	array<Frame, historyLength> history{};
+	Frame current;
+	sizet next = 0;
+	uint64 lastFrame = 0;
+	float msPerTick;
+
+public:
+	FrameStats();
+
+	void add(Phase phase, uint64 ticks);
+	void finishFrame(uint64 now);
+	const Frame& frame(sizet age) const;	// 0 is the newest finished frame
+	Frame average() const;
+	float maxInterval() const;
+};
+
+inline FrameStats::FrameStats() :
+	msPerTick(1000.f / float(SDL_GetPerformanceFrequency()))
+{}
+
+inline void FrameStats::add(Phase phase, uint64 ticks) {
+	current.phases[uint8(phase)] += float(ticks) * msPerTick;
+}
+
+inline const FrameStats::Frame& FrameStats::frame(sizet age) const {
+	return history[(next + historyLength - 1 - age) % historyLength];
+}
 
 // handles window events and contains video settings
 class WindowSys {
@@ -14,17 +71,23 @@ private:
 
 	FileSys* fileSys;
 	DrawSys* drawSys;
+	InputTrace* inputTrace;	// null unless recording or replaying
 	InputSys* inputSys;
+	MemoryGovernor* memGovernor;
 	Program* program;
 	Scene* scene;
 	Settings* sets;
 	umap<int, SDL_Window*> windows;
+	FrameStats frameStats;
 	float winDpi;
+	Settings::Renderer rendererOverride = Settings::Renderer::max;	// from the command line for this run only, max if none
 	float dSec = 0.f;		// delta seconds, aka the time between each iteration of the above mentioned loop
 	bool run = true;		// whether the loop in which the program runs should continue
+	bool headless = false;	// no visible output and no saving of settings
+	bool showStats = false;
 
 public:
-	int start();
+	int start(const std::function<void()>& body = nullptr);	// body runs instead of the main loop if set
 	void close();
 
 	float getDSec() const;
@@ -34,27 +97,36 @@ public:
 	ivec2 displayResolution() const;
 	void moveCursor(ivec2 mov);
 	void toggleOpacity();
+	void toggleFrameStats();
 	void setScreenMode(Settings::Screen sm);
 	void setWindowPos(ivec2 pos);
 	void setResolution(ivec2 res);
+	Settings::Renderer getRenderer() const;
+	void setRenderer(Settings::Renderer rnd);
 	void resetSettings();
 	void recreateWindows();
 
 	FileSys* getFileSys();
 	DrawSys* getDrawSys();
+	InputTrace* getInputTrace();
 	InputSys* getInputSys();
+	MemoryGovernor* getMemoryGovernor();
 	Program* getProgram();
 	Scene* getScene();
 	Settings* getSets();
+	const FrameStats& getFrameStats() const;
 
 private:
 	void init();
 	void exec();
+	void benchOpen(const fs::path& book, uint repeat);
 
 	void createWindow();
 	void createSingleWindow(uint32 flags, SDL_Surface* icon);
 	void createMultiWindow(uint32 flags, SDL_Surface* icon);
 	void destroyWindows();
+	bool windowsVisible() const;
+	uint32 eventWaitTime(uint32 drawTime) const;
 	void handleEvent(const SDL_Event& event);	// pass events to their specific handlers
 	void eventWindow(const SDL_WindowEvent& winEvent);
 	void eventDisplay(const SDL_DisplayEvent& dspEvent);
@@ -80,6 +152,10 @@ inline InputSys* WindowSys::getInputSys() {
 	return inputSys;
 }
 
+inline MemoryGovernor* WindowSys::getMemoryGovernor() {
+	return memGovernor;
+}
+
 inline Program* WindowSys::getProgram() {
 	return program;
 }
@@ -88,6 +164,10 @@ inline Scene* WindowSys::getScene() {
 	return scene;
 }
 
+inline InputTrace* WindowSys::getInputTrace() {
+	return inputTrace;
+}
+
 inline Settings* WindowSys::getSets() {
 	return sets;
 }
@@ -95,3 +175,11 @@ inline Settings* WindowSys::getSets() {
 inline float WindowSys::getWinDpi() const {
 	return winDpi;
 }
+
+inline Settings::Renderer WindowSys::getRenderer() const {
+	return rendererOverride != Settings::Renderer::max ? rendererOverride : sets->renderer;
+}
+
+inline const FrameStats& WindowSys::getFrameStats() const {
+	return frameStats;
+}
@@ -3,12 +3,7 @@
 #include <windows.h>
 #endif
 
-template <class C, class F>
-void World::setArgs(int argc, C** argv, F conv) {
-	vals.resize(argc - 1);
-	std::transform(argv + 1, argv + argc, vals.begin(), conv);
-}
-
+#ifndef BENCHMARK
 #ifdef _WIN32
 #ifdef __MINGW32__
 int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR lpCmdLine, int) {
@@ -26,3 +21,4 @@ int main(int argc, char** argv) {
 #endif
 	return World::winSys()->start();
 }
+#endif
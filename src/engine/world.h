@@ -6,8 +6,20 @@
 // class that makes accessing stuff easier and holds command line arguments
 class World {
 private:
+	static constexpr array<const char*, 7> valueOptions = {	// options that take the next argument as their value
+		"bench-open",
+		"record",
+		"renderer",
+		"repeat",
+		"replay",
+		"settings",
+		"trace"
+	};
+
 	static inline WindowSys windowSys;			// the thing on which everything runs
 	static inline vector<string> vals;
+	static inline umap<string, string> opts;	// "--key value" for keys in valueOptions
+	static inline uset<string> flags;			// any other "--key"
 
 public:
 	static FileSys* fileSys();
@@ -22,6 +34,8 @@ public:
 	static Settings* sets();
 
 	static const vector<string>& getVals();
+	static const string* getOpt(const string& key);
+	static bool hasFlag(const string& key);
 	template <class C, class F> static void setArgs(int argc, C** argv, F conv);
 
 	template <class F, class... A> static void prun(F func, A... args);
@@ -74,6 +88,28 @@ inline const vector<string>& World::getVals() {
 	return vals;
 }
 
+inline const string* World::getOpt(const string& key) {
+	umap<string, string>::const_iterator it = opts.find(key);
+	return it != opts.end() ? &it->second : nullptr;
+}
+
+inline bool World::hasFlag(const string& key) {
+	return flags.count(key);
+}
+
+template <class C, class F>
+void World::setArgs(int argc, C** argv, F conv) {
+	for (int i = 1; i < argc; ++i) {
+		string arg = conv(argv[i]);
+		if (arg.length() <= 2 || arg[0] != '-' || arg[1] != '-')
+			vals.push_back(std::move(arg));
+		else if (string key = arg.substr(2); i + 1 < argc && std::any_of(valueOptions.begin(), valueOptions.end(), [&key](const char* it) -> bool { return key == it; }))
+			opts.insert_or_assign(std::move(key), conv(argv[++i]));
+		else
+			flags.insert(std::move(key));
+	}
+}
+
 template <class F, class... A>
 void World::prun(F func, A... args) {
 	run(program(), func, args...);
@@ -1,7 +1,9 @@
 #include "browser.h"
 #include "engine/drawSys.h"
 #include "engine/fileSys.h"
+#include "engine/memoryGovernor.h"
 #include "engine/world.h"
+#include "utils/trace.h"
 #ifdef _WIN32
 #include <SDL_image.h>
 #else
@@ -183,10 +185,30 @@ pair<vector<string>, vector<string>> Browser::listCurDir() const {
 	return out;
 }
 
+// entries are numbered with directories first
 void Browser::startPreview(const vector<string>& files, const vector<string>& dirs, int maxHeight) {
 	stopPreview();
+	vector<pair<sizet, string>> fids(files.size()), dids(dirs.size());
+	for (sizet i = 0; i < dirs.size(); ++i)
+		dids[i] = pair(i, dirs[i]);
+	for (sizet i = 0; i < files.size(); ++i)
+		fids[i] = pair(dirs.size() + i, files[i]);
+
 	previewRunning = true;
-	previewProc = std::thread(&Browser::previewThread, std::ref(previewRunning), curDir, files, dirs, World::sets()->showHidden, maxHeight);
+	previewPaused = World::winSys()->getMemoryGovernor()->getPressure() != MemoryGovernor::Pressure::none;
+	previewProc = std::thread(&Browser::previewThread, std::ref(previewRunning), std::cref(previewPaused), curDir, std::move(fids), std::move(dids), World::sets()->showHidden, maxHeight);
+}
+
+// previews that got evicted are loaded again while the others stay, but only once the last batch is done
+bool Browser::restorePreviews(const vector<pair<sizet, string>>& files, const vector<pair<sizet, string>>& dirs, int maxHeight) {
+	if (previewRunning)
+		return false;
+	if (previewProc.joinable())
+		previewProc.join();
+
+	previewRunning = true;
+	previewProc = std::thread(&Browser::previewThread, std::ref(previewRunning), std::cref(previewPaused), curDir, files, dirs, World::sets()->showHidden, maxHeight);
+	return true;
 }
 
 void Browser::stopPreview() {
@@ -207,26 +229,44 @@ void Browser::stopPreview() {
 	}
 }
 
-void Browser::previewThread(std::atomic_bool& running, fs::path curDir, vector<string> files, vector<string> dirs, bool showHidden, int maxHeight) {
-	for (sizet i = 0; i < dirs.size(); ++i) {
-		if (!running)
+void Browser::freePreviewTexture(const Texture* tex) {
+	if (vector<Texture*>::iterator it = std::find(previewTexes.begin(), previewTexes.end(), tex); it != previewTexes.end()) {
+		World::drawSys()->freeTexture(*it);
+		previewTexes.erase(it);
+	}
+}
+
+void Browser::previewThread(std::atomic_bool& running, const std::atomic_bool& paused, fs::path curDir, vector<pair<sizet, string>> files, vector<pair<sizet, string>> dirs, bool showHidden, int maxHeight) {
+	Trace::Zone zone("preview");
+	zone.setPath(curDir);
+	for (const auto& [id, name] : dirs) {
+		if (!waitPreview(running, paused))
 			return;
-		for (const fs::path& sit : FileSys::listDir(curDir / dirs[i], true, false, showHidden))
-			if (SDL_Surface* img = loadAndScale(curDir / dirs[i] / sit, maxHeight)) {
-				pushEvent(SDL_USEREVENT_PREVIEW_PROGRESS, reinterpret_cast<void*>(i), img);
+		for (const fs::path& sit : FileSys::listDir(curDir / name, true, false, showHidden))
+			if (SDL_Surface* img = loadAndScale(curDir / name / sit, maxHeight)) {
+				pushEvent(SDL_USEREVENT_PREVIEW_PROGRESS, reinterpret_cast<void*>(id), img);
 				break;
 			}
 	}
-	for (sizet i = 0; i < files.size(); ++i) {
-		if (!running)
+	for (const auto& [id, name] : files) {
+		if (!waitPreview(running, paused))
 			return;
-		if (SDL_Surface* img = loadAndScale(curDir / files[i], maxHeight))
-			pushEvent(SDL_USEREVENT_PREVIEW_PROGRESS, reinterpret_cast<void*>(i + dirs.size()), img);
+		if (SDL_Surface* img = loadAndScale(curDir / name, maxHeight))
+			pushEvent(SDL_USEREVENT_PREVIEW_PROGRESS, reinterpret_cast<void*>(id), img);
 	}
 	running = false;
 }
 
+// returns false if the preview got stopped while waiting
+bool Browser::waitPreview(const std::atomic_bool& running, const std::atomic_bool& paused) {
+	while (paused && running)
+		SDL_Delay(previewPauseDelay);
+	return running;
+}
+
 SDL_Surface* Browser::loadAndScale(const fs::path& file, int maxHeight) {
+	Trace::Zone zone("previewImage");
+	zone.setPath(file);
 	SDL_Surface* img = IMG_Load(file.u8string().c_str());
 	if (img && img->h > maxHeight)
 		if (SDL_Surface* dst = SDL_CreateRGBSurfaceWithFormat(0, int(float(img->w) * float(maxHeight) / float(img->h)), maxHeight, img->format->BytesPerPixel, img->format->format)) {
@@ -234,6 +274,8 @@ SDL_Surface* Browser::loadAndScale(const fs::path& file, int maxHeight) {
 			SDL_FreeSurface(img);
 			img = dst;
 		}
+	if (img)
+		zone.setBytes(uptrt(img->pitch) * uptrt(img->h));
 	return img;
 }
 
@@ -12,11 +12,16 @@ public:
 #else
 	static constexpr char topDir[] = "/";
 #endif
+private:
+	static constexpr uint32 previewPauseDelay = 100;	// milliseconds between checks whether paused previews may continue
+
+public:
 
 	PCall exCall;	// gets called when goUp() fails, aka stepping out of rootDir into the previous menu
 private:
 	std::thread previewProc;
 	std::atomic_bool previewRunning;
+	std::atomic_bool previewPaused = false;	// no new previews get decoded while memory is tight
 	vector<Texture*> previewTexes;
 
 	fs::path rootDir;	// the top directory one can visit
@@ -43,9 +48,12 @@ public:
 	pair<vector<string>, vector<string>> listCurDir() const;
 
 	void pushPreviewTexture(Texture* tex);
+	void freePreviewTexture(const Texture* tex);
 	void startPreview(const vector<string>& files, const vector<string>& dirs, int maxHeight);
+	bool restorePreviews(const vector<pair<sizet, string>>& files, const vector<pair<sizet, string>>& dirs, int maxHeight);
 	void stopPreview();
-	static void previewThread(std::atomic_bool& running, fs::path curDir, vector<string> files, vector<string> dirs, bool showHidden, int maxHeight);
+	void pausePreview(bool pause);
+	static void previewThread(std::atomic_bool& running, const std::atomic_bool& paused, fs::path curDir, vector<pair<sizet, string>> files, vector<pair<sizet, string>> dirs, bool showHidden, int maxHeight);
 	static SDL_Surface* loadAndScale(const fs::path& file, int maxHeight);
 
 private:
@@ -55,6 +63,7 @@ private:
 	bool nextArchive(const fs::path& ait, const fs::path& pdir);
 	string nextDirFile(string_view file, bool fwd) const;
 	string nextArchiveFile(string_view file, bool fwd) const;
+	static bool waitPreview(const std::atomic_bool& running, const std::atomic_bool& paused);
 
 	template <class T, class P, class F, class... A> static bool foreachFAround(const vector<T>& vec, typename vector<T>::const_iterator start, P* parent, F func, A... args);
 	template <class T, class P, class F, class... A> static bool foreachRAround(const vector<T>& vec, typename vector<T>::const_reverse_iterator start, P* parent, F func, A... args);
@@ -88,3 +97,7 @@ inline string Browser::nextFile(string_view file, bool fwd) const {
 inline void Browser::pushPreviewTexture(Texture* tex) {
 	previewTexes.push_back(tex);
 }
+
+inline void Browser::pausePreview(bool pause) {
+	previewPaused = pause;
+}
@@ -3,12 +3,15 @@
 #include "engine/drawSys.h"
 #include "engine/fileSys.h"
 #include "engine/inputSys.h"
+#include "engine/inputTrace.h"
+#include "engine/memoryGovernor.h"
 #include "engine/scene.h"
 #include "utils/layouts.h"
 
 // PROGRAM
 
 Program::~Program() {
+	stopReload();
 	delete state;
 }
 
@@ -58,6 +61,8 @@ void Program::eventDeleteBook(Button*) {
 		Label* lbl = World::scene()->getContext()->owner<Label>();
 		fs::remove_all(World::sets()->getDirLib() / fs::u8path(lbl->getText()));
 		World::scene()->setContext(nullptr);
+		vector<string>& books = static_cast<ProgBooks*>(state)->books;
+		books.erase(books.begin() + pdift(lbl->getIndex()));
 		lbl->getParent()->deleteWidget(lbl->getIndex());
 	} catch (const std::runtime_error& err) {
 		World::scene()->setPopup(state->createPopupMessage(err.what(), &Program::eventClosePopup));
@@ -88,14 +93,14 @@ bool Program::openFile(const fs::path& file) {
 
 void Program::eventBrowserGoUp(Button*) {
 	if (browser->goUp())
-		World::scene()->resetLayouts();
+		state->eventDirChange();
 	else
 		eventExitBrowser();
 }
 
 void Program::eventBrowserGoIn(Button* but) {
 	if (browser->goIn(fs::u8path(static_cast<Label*>(but)->getText())))
-		World::scene()->resetLayouts();
+		state->eventDirChange();
 }
 
 void Program::eventBrowserGoFile(Button* but) {
@@ -104,14 +109,14 @@ void Program::eventBrowserGoFile(Button* but) {
 		eventStartLoadingReader(browser->getCurFile().u8string());
 		break;
 	case fs::file_type::directory:
-		World::scene()->resetLayouts();
+		state->eventDirChange();
 	}
 }
 
 void Program::eventBrowserGoTo(Button* but) {
 	switch (LabelEdit* le = static_cast<LabelEdit*>(but); browser->goTo(browser->getRootDir() == Browser::topDir ? fs::u8path(le->getText()) : World::sets()->getDirLib() / fs::u8path(le->getText()))) {
 	case fs::file_type::directory:
-		World::scene()->resetLayouts();
+		state->eventDirChange();
 		break;
 	case fs::file_type::regular:
 		eventStartLoadingReader(browser->getCurFile().u8string());
@@ -124,9 +129,13 @@ void Program::eventBrowserGoTo(Button* but) {
 
 void Program::eventPreviewProgress(const SDL_UserEvent& user) {
 	ProgPageBrowser* pb = static_cast<ProgPageBrowser*>(state);
-	if (Texture* tex = World::drawSys()->texFromImg(static_cast<SDL_Surface*>(user.data2))) {
+	if (Texture* tex = World::drawSys()->texFromImg(static_cast<SDL_Surface*>(user.data2), Texture::Owner::preview)) {
 		browser->pushPreviewTexture(tex);
-		static_cast<Label*>(pb->fileList->getWidget(uptrt(user.data1)))->tex = tex;
+		pb->icons[uptrt(user.data1)] = tex;
+		if (Label* lbl = static_cast<Label*>(pb->fileList->getWidget(uptrt(user.data1)))) {
+			lbl->tex = tex;
+			World::drawSys()->invalidate(lbl);
+		}
 	}
 }
 
@@ -140,8 +149,12 @@ void Program::eventExitBrowser(Button*) {
 
 void Program::eventStartLoadingReader(const string& first, bool fwd) {
 	World::scene()->setPopup(state->createPopupMessage("Loading...", &Program::eventReaderLoadingCancelled, "Cancel", Alignment::center));
+	if (InputTrace* trace = World::winSys()->getInputTrace())
+		trace->startLoad();
+	stopReload();
 	threadRunning = true;
-	thread = std::thread(browser->getInArchive() ? &DrawSys::loadTexturesArchiveThreaded : &DrawSys::loadTexturesDirectoryThreaded, std::ref(threadRunning), std::make_unique<PictureLoader>(browser->getCurDir(), first, World::sets()->picLim, fwd, World::sets()->showHidden));
+	PicLim plim = World::winSys()->getMemoryGovernor()->limitPictures(World::sets()->picLim, World::drawSys()->textureMemory(Texture::Owner::reader));
+	thread = std::thread(browser->getInArchive() ? &DrawSys::loadTexturesArchiveThreaded : &DrawSys::loadTexturesDirectoryThreaded, std::ref(threadRunning), std::make_unique<PictureLoader>(browser->getCurDir(), first, plim, fwd, World::sets()->showHidden, World::drawSys()->getReaderBytesPerPixel()));
 }
 
 void Program::eventReaderLoadingCancelled(Button*) {
@@ -157,11 +170,61 @@ void Program::eventReaderProgress(const SDL_UserEvent& user) {
 
 void Program::eventReaderFinished(const SDL_UserEvent& user) {
 	thread.join();
+	stopReload();
 	setState<ProgReader>();
 
 	PictureLoader* pl = static_cast<PictureLoader*>(user.data1);
 	static_cast<ProgReader*>(state)->reader->setWidgets(World::drawSys()->transferPictures(pl));
 	delete pl;
+	if (InputTrace* trace = World::winSys()->getInputTrace())
+		trace->finishLoad();
+}
+
+// evicted pages are decoded again in the background and go back into the reader when they're done
+void Program::eventReloadPictures(vector<string>&& names) {
+	if (reloadThread.joinable() || thread.joinable())	// the pages would go into the wrong book if it gets switched
+		return;
+
+	uptr<PictureLoader> pl = std::make_unique<PictureLoader>(browser->getCurDir(), string(), PicLim(), true, World::sets()->showHidden);
+	pl->names = std::move(names);
+	reloadRunning = true;
+	reloadThread = std::thread(browser->getInArchive() ? &DrawSys::reloadTexturesArchiveThreaded : &DrawSys::reloadTexturesDirectoryThreaded, std::ref(reloadRunning), std::move(pl));
+}
+
+void Program::eventReaderReloaded(const SDL_UserEvent& user) {
+	reloadThread.join();
+	PictureLoader* pl = static_cast<PictureLoader*>(user.data1);
+	if (ProgReader* pr = dynamic_cast<ProgReader*>(state)) {
+		// pages that went missing or don't decode anymore would otherwise be asked for again every frame
+		vector<bool> found(pl->names.size(), false);
+		for (const auto& [id, img] : pl->pics)
+			found[id] = true;
+		for (sizet i = 0; i < found.size(); ++i)
+			if (!found[i])
+				pr->reader->losePicture(pl->names[i]);
+
+		for (auto& [name, tex] : World::drawSys()->transferPictures(pl))
+			if (!tex)
+				pr->reader->losePicture(name);
+			else if (!pr->reader->restorePicture(name, tex))
+				World::drawSys()->freeTexture(tex);
+	}
+	delete pl;
+}
+
+void Program::stopReload() {
+	if (reloadThread.joinable()) {
+		reloadRunning = false;
+		reloadThread.join();
+	}
+
+	array<SDL_Event, 16> events;
+	while (int num = SDL_PeepEvents(events.data(), events.size(), SDL_GETEVENT, SDL_USEREVENT_READER_RELOADED, SDL_USEREVENT_READER_RELOADED)) {
+		if (num < 0)
+			throw std::runtime_error(SDL_GetError());
+		for (int i = 0; i < num; ++i)
+			delete static_cast<PictureLoader*>(events[i].user.data1);
+	}
 }
 
 void Program::eventZoomIn(Button*) {
@@ -200,6 +263,7 @@ void Program::switchPictures(bool fwd, string_view picname) {
 }
 
 void Program::eventExitReader(Button*) {
+	stopReload();
 	state->eventClosing();
 	setState<ProgPageBrowser>();
 }
@@ -398,10 +462,8 @@ void Program::eventSetScreenMode(Button* but) {
 }
 
 void Program::eventSetRenderer(Button* but) {
-	if (Settings::Renderer renderer = Settings::Renderer(finishComboBox(but)); World::sets()->renderer != renderer) {
-		World::sets()->renderer = renderer;
-		World::winSys()->recreateWindows();
-	}
+	if (Settings::Renderer renderer = Settings::Renderer(finishComboBox(but)); World::winSys()->getRenderer() != renderer)
+		World::winSys()->setRenderer(renderer);
 }
 
 void Program::eventSetDevice(Button* but) {
@@ -449,13 +511,13 @@ void Program::eventSetHide(Button* but) {
 }
 
 void Program::eventSetTooltips(Button* but) {
-	World::sets()->tooltips = static_cast<CheckBox*>(but)->on;
-	World::scene()->resetLayouts();
+	World::sets()->tooltips = static_cast<CheckBox*>(but)->on;	// tooltips are always created but only shown if enabled
+	World::drawSys()->invalidate();
 }
 
 void Program::eventSetTheme(Button* but) {
 	World::drawSys()->setTheme(static_cast<ComboBox*>(but)->getText(), World::sets(), World::fileSys());
-	World::scene()->resetLayouts();
+	World::drawSys()->invalidate();	// widgets look up their colors when drawn
 }
 
 void Program::eventSetFont(Button* but) {
@@ -592,6 +654,28 @@ void Program::eventForceExit(Button*) {
 	World::winSys()->close();
 }
 
+// background decoding stops as soon as memory gets tight and only resumes once the pressure is gone
+void Program::eventMemoryPressure() {
+	MemoryGovernor::Pressure pressure = World::winSys()->getMemoryGovernor()->getPressure();
+	if (browser)
+		browser->pausePreview(pressure != MemoryGovernor::Pressure::none);
+	if (pressure == MemoryGovernor::Pressure::critical) {
+		state->eventMemoryPressure();
+		World::drawSys()->logTextureMemory();
+	}
+}
+
+// textures over the budget are let go starting with those that went unseen the longest, while evicted ones come back once they're near the view again
+void Program::eventTextureResidency() {
+	if (World::drawSys()->overTextureBudget()) {
+		vector<ResidentTexture> res;
+		state->listResidents(res);
+		if (res = World::drawSys()->pickEvictions(std::move(res)); !res.empty())
+			state->evictResidents(res);
+	}
+	state->restoreResidents();
+}
+
 template <class T, class... A>
 void Program::setState(A&&... args) {
 	delete state;
@@ -15,6 +15,8 @@ private:
 	uptr<Browser> browser;
 	std::thread thread;
 	std::atomic_bool threadRunning;
+	std::thread reloadThread;	// decodes evicted reader pages again
+	std::atomic_bool reloadRunning;
 
 public:
 	~Program();
@@ -42,6 +44,8 @@ public:
 	void eventReaderLoadingCancelled(Button* but = nullptr);
 	void eventReaderProgress(const SDL_UserEvent& user);
 	void eventReaderFinished(const SDL_UserEvent& user);
+	void eventReloadPictures(vector<string>&& names);
+	void eventReaderReloaded(const SDL_UserEvent& user);
 	void eventZoomIn(Button* but = nullptr);
 	void eventZoomOut(Button* but = nullptr);
 	void eventZoomReset(Button* but = nullptr);
@@ -116,13 +120,17 @@ public:
 	void eventResizeComboContext(Layout* lay = nullptr);
 	void eventTryExit(Button* but = nullptr);
 	void eventForceExit(Button* but = nullptr);
+	void eventMemoryPressure();
+	void eventTextureResidency();
 
 	Downloader* getDownloader();
 	ProgState* getState();
 	Browser* getBrowser();
+	bool busy() const;	// whether a background task is running
 
 private:
 	void switchPictures(bool fwd, string_view picname);
+	void stopReload();
 	void offerMoveBooks(fs::path&& oldLib);
 	static sizet finishComboBox(Button* but);
 	template <class T, class... A> void setState(A&&... args);
@@ -137,6 +145,10 @@ inline Browser* Program::getBrowser() {
 	return browser.get();
 }
 
+inline bool Program::busy() const {
+	return thread.joinable() || reloadThread.joinable();
+}
+
 inline Downloader* Program::getDownloader() {
 	return &downloader;
 }
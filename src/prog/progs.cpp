@@ -88,6 +88,14 @@ void ProgState::eventRefresh() {
 	World::scene()->resetLayouts();
 }
 
+void ProgState::eventFrameStats() {
+	World::winSys()->toggleFrameStats();
+}
+
+void ProgState::eventDirChange() {
+	World::scene()->resetLayouts();
+}
+
 void ProgState::onResize() {
 	popupLineHeight = int(40.f / WindowSys::fallbackDpi * World::winSys()->getWinDpi());
 	tooltipHeight = int(16.f / WindowSys::fallbackDpi * World::winSys()->getWinDpi());
@@ -187,14 +195,11 @@ int ProgState::findMaxLength(T pos, T end, int height) {
 	return width;
 }
 
-Texture* ProgState::makeTooltip(const char* str) {
-	return World::sets()->tooltips ? World::drawSys()->renderText(str, tooltipHeight, maxTooltipLength) : nullptr;
+Tooltip* ProgState::makeTooltip(const char* str) {
+	return new Tooltip(str, tooltipHeight, maxTooltipLength);
 }
 
-Texture* ProgState::makeTooltipL(const char* str) {
-	if (!World::sets()->tooltips)
-		return nullptr;
-
+Tooltip* ProgState::makeTooltipL(const char* str) {
 	uint width = 0;
 	for (const char* pos = str; *pos;) {
 		sizet len = strcspn(pos, "\n");
@@ -203,7 +208,44 @@ Texture* ProgState::makeTooltipL(const char* str) {
 				break;
 		pos += pos[len] ? len + 1 : len;
 	}
-	return World::drawSys()->renderText(str, tooltipHeight, width);
+	return new Tooltip(str, tooltipHeight, width);
+}
+
+// tooltips are rendered again the next time they're shown
+void ProgState::listResidents(vector<ResidentTexture>& res) {
+	vector<Button*> buts = tooltipOwners();
+	for (sizet i = 0; i < buts.size(); ++i)
+		res.push_back(ResidentTexture{ buts[i]->renderedTooltip(), Texture::Owner::text, i, 0 });
+}
+
+void ProgState::evictResidents(const vector<ResidentTexture>& evs) {
+	vector<Button*> buts = tooltipOwners();
+	for (const ResidentTexture& it : evs)
+		if (it.owner == Texture::Owner::text)
+			buts[it.id]->releaseCache();
+}
+
+sizet ProgState::viewDistance(mvec2 vis, sizet id) {
+	if (id < vis.x)
+		return vis.x - id;
+	return id >= vis.y ? id - vis.y + 1 : 0;
+}
+
+vector<Button*> ProgState::tooltipOwners() {
+	vector<Button*> buts;
+	for (Widget* it : initlist<Widget*>{ World::scene()->getLayout(), World::scene()->getOverlay(), World::scene()->getPopup() })
+		if (it)
+			collectTooltips(it, buts);
+	return buts;
+}
+
+void ProgState::collectTooltips(Widget* wgt, vector<Button*>& buts) {
+	if (Layout* box = dynamic_cast<Layout*>(wgt)) {
+		for (Widget* it : box->getWidgets())
+			if (it)
+				collectTooltips(it, buts);
+	} else if (Button* but = dynamic_cast<Button*>(wgt); but && but->renderedTooltip())
+		buts.push_back(but);
 }
 
 // PROG BOOKS
@@ -236,22 +278,37 @@ RootLayout* ProgBooks::createLayout() {
 	};
 
 	// book list
-	vector<fs::path> books = FileSys::listDir(World::sets()->getDirLib(), false, true, World::sets()->showHidden);
-	vector<Widget*> tiles(books.size()+1);
-	for (sizet i = 0; i < books.size(); ++i) {
-		Text txt(books[i].u8string(), TileBox::defaultItemHeight);
-		tiles[i] = new Label(txt.length, std::move(txt.text), &Program::eventOpenPageBrowser, &Program::eventOpenBookContext);
+	vector<fs::path> dirs = FileSys::listDir(World::sets()->getDirLib(), false, true, World::sets()->showHidden);
+	books.resize(dirs.size());
+	vector<Size> tiles(dirs.size() + 1);
+	for (sizet i = 0; i < dirs.size(); ++i) {
+		books[i] = dirs[i].u8string();
+		tiles[i] = World::drawSys()->textLength(books[i], TileBox::defaultItemHeight) + Label::defaultTextMargin * 2;
 	}
-	tiles.back() = new Button(TileBox::defaultItemHeight, &Program::eventOpenPageBrowser, &Program::eventOpenBookContext, nullptr, makeTooltip("Browse other directories"), true, World::drawSys()->texture("search"));
+	tiles.back() = TileBox::defaultItemHeight;
 
 	// root layout
 	vector<Widget*> cont = {
 		new Layout(topHeight, std::move(top), Direction::right, Layout::Select::none, topSpacing),
-		new TileBox(1.f, std::move(tiles))
+		new TileBox(1.f, std::move(tiles), this)
 	};
 	return new RootLayout(1.f, std::move(cont), Direction::down, Layout::Select::none, topSpacing);
 }
 
+Widget* ProgBooks::createItem(sizet id) {
+	if (id < books.size())
+		return new Label(World::drawSys()->textLength(books[id], TileBox::defaultItemHeight) + Label::defaultTextMargin * 2, books[id], &Program::eventOpenPageBrowser, &Program::eventOpenBookContext);
+	return new Button(TileBox::defaultItemHeight, &Program::eventOpenPageBrowser, &Program::eventOpenBookContext, nullptr, makeTooltip("Browse other directories"), true, World::drawSys()->texture("search"));
+}
+
+bool ProgBooks::reuseItem(Widget* wgt, sizet id) {
+	Label* lbl = dynamic_cast<Label*>(wgt);	// the last tile is a plain button
+	if (!lbl || id >= books.size())
+		return false;
+	lbl->setText(books[id]);
+	return true;
+}
+
 // PROG PAGE BROWSER
 
 void ProgPageBrowser::eventEscape() {
@@ -261,13 +318,71 @@ void ProgPageBrowser::eventEscape() {
 
 void ProgPageBrowser::eventHide() {
 	ProgState::eventHide();
-	World::scene()->resetLayouts();
+	eventDirChange();
 }
 
 void ProgPageBrowser::eventFileDrop(const fs::path& file) {
 	World::program()->openFile(file);
 }
 
+void ProgPageBrowser::eventDirChange() {
+	// keep the frame and only swap out the list's content
+	World::scene()->onMouseLeave();
+	locationBar->setText(locationText());
+	fileList->setItems(loadEntries());
+	World::scene()->updateSelect();
+}
+
+// previews farther than a screen away from the view go back to the default icons
+void ProgPageBrowser::eventMemoryPressure() {
+	mvec2 vis = fileList->visibleWidgets();
+	sizet margin = vis.y - vis.x;
+	for (sizet i = 0; i < icons.size(); ++i)
+		if (viewDistance(vis, i) > margin && icons[i]->getOwner() == Texture::Owner::preview)
+			evictPreview(i);
+}
+
+void ProgPageBrowser::listResidents(vector<ResidentTexture>& res) {
+	ProgState::listResidents(res);
+	mvec2 vis = fileList->visibleWidgets();
+	sizet margin = vis.y - vis.x;
+	for (sizet i = 0; i < icons.size(); ++i)
+		if (sizet dist = viewDistance(vis, i); dist > margin && icons[i]->getOwner() == Texture::Owner::preview)
+			res.push_back(ResidentTexture{ icons[i], Texture::Owner::preview, i, dist });
+}
+
+void ProgPageBrowser::evictResidents(const vector<ResidentTexture>& evs) {
+	ProgState::evictResidents(evs);
+	for (const ResidentTexture& it : evs)
+		if (it.owner == Texture::Owner::preview)
+			evictPreview(it.id);
+}
+
+// evicted previews within a screen of the view get loaded again
+void ProgPageBrowser::restoreResidents() {
+	mvec2 vis = fileList->visibleWidgets();
+	sizet margin = vis.y - vis.x;
+	vector<pair<sizet, string>> files, dirs;
+	for (sizet i = vis.x > margin ? vis.x - margin : 0, e = std::min(vis.y + margin, entries.size()); i < e; ++i)
+		if (previewEvicted[i])
+			(i < dirCount ? dirs : files).emplace_back(i, entries[i]);
+	if ((!files.empty() || !dirs.empty()) && World::browser()->restorePreviews(files, dirs, lineHeight)) {
+		for (const auto& [id, name] : files)
+			previewEvicted[id] = false;
+		for (const auto& [id, name] : dirs)
+			previewEvicted[id] = false;
+	}
+}
+
+void ProgPageBrowser::evictPreview(sizet id) {
+	const Texture* icon = World::drawSys()->texture(id < dirCount ? "folder" : "file");
+	if (Label* lbl = static_cast<Label*>(fileList->getWidget(id)))
+		lbl->tex = icon;
+	World::browser()->freePreviewTexture(icons[id]);
+	icons[id] = icon;
+	previewEvicted[id] = true;
+}
+
 RootLayout* ProgPageBrowser::createLayout() {
 	// sidebar
 	initlist<const char*> txs = {
@@ -281,30 +396,50 @@ RootLayout* ProgPageBrowser::createLayout() {
 		new Label(lineHeight, *itxs++, &Program::eventBrowserGoUp)
 	};
 
-	// list of files and directories
-	auto [files, dirs] = World::browser()->listCurDir();
-	if (World::sets()->preview)
-		World::browser()->startPreview(files, dirs, lineHeight);
-	vector<Widget*> items(files.size() + dirs.size());
-	for (sizet i = 0; i < dirs.size(); ++i)
-		items[i] = new Label(lineHeight, std::move(dirs[i]), &Program::eventBrowserGoIn, nullptr, nullptr, nullptr, Alignment::left, World::drawSys()->texture("folder"));
-	for (sizet i = 0; i < files.size(); ++i)
-		items[dirs.size() + i] = new Label(lineHeight, std::move(files[i]), &Program::eventBrowserGoFile, nullptr, nullptr, nullptr, Alignment::left, World::drawSys()->texture("file"));
-
 	// main content
 	vector<Widget*> mid = {
 		new Layout(txsWidth, std::move(bar)),
-		fileList = new ScrollArea(1.f, std::move(items))
+		fileList = new ScrollArea(1.f, loadEntries(), this)
 	};
 
 	// root layout
 	vector<Widget*> cont = {
-		new LabelEdit(lineHeight, World::browser()->getRootDir() != Browser::topDir ? relativePath(World::browser()->getCurDir(), World::sets()->getDirLib()).u8string() : World::browser()->getCurDir().u8string(), &Program::eventBrowserGoTo),
+		locationBar = new LabelEdit(lineHeight, locationText(), &Program::eventBrowserGoTo),
 		new Layout(1.f, std::move(mid), Direction::right, Layout::Select::none, topSpacing)
 	};
 	return new RootLayout(1.f, std::move(cont), Direction::down, Layout::Select::none, topSpacing);
 }
 
+Widget* ProgPageBrowser::createItem(sizet id) {
+	return new Label(lineHeight, entries[id], id < dirCount ? &Program::eventBrowserGoIn : &Program::eventBrowserGoFile, nullptr, nullptr, nullptr, Alignment::left, icons[id]);
+}
+
+bool ProgPageBrowser::reuseItem(Widget* wgt, sizet id) {
+	Label* lbl = static_cast<Label*>(wgt);
+	lbl->setText(entries[id]);
+	lbl->setCalls(id < dirCount ? &Program::eventBrowserGoIn : &Program::eventBrowserGoFile);
+	lbl->tex = icons[id];
+	return true;
+}
+
+vector<Size> ProgPageBrowser::loadEntries() {
+	auto [files, dirs] = World::browser()->listCurDir();
+	if (World::sets()->preview)
+		World::browser()->startPreview(files, dirs, lineHeight);
+	dirCount = dirs.size();
+	entries = std::move(dirs);
+	entries.insert(entries.end(), std::make_move_iterator(files.begin()), std::make_move_iterator(files.end()));
+	icons.resize(entries.size());
+	previewEvicted.assign(entries.size(), false);
+	std::fill(icons.begin(), icons.begin() + pdift(dirCount), World::drawSys()->texture("folder"));
+	std::fill(icons.begin() + pdift(dirCount), icons.end(), World::drawSys()->texture("file"));
+	return vector<Size>(entries.size(), lineHeight);
+}
+
+string ProgPageBrowser::locationText() {
+	return World::browser()->getRootDir() != Browser::topDir ? relativePath(World::browser()->getCurDir(), World::sets()->getDirLib()).u8string() : World::browser()->getCurDir().u8string();
+}
+
 // PROG READER
 
 void ProgReader::eventEscape() {
@@ -391,6 +526,42 @@ void ProgReader::eventHide() {
 	World::program()->eventStartLoadingReader(reader->firstPage());
 }
 
+void ProgReader::eventMemoryPressure() {
+	mvec2 vis = reader->visibleWidgets();
+	sizet cnt = reader->getWidgets().size();
+	reader->removePictures(cnt - std::min(vis.y + pressureKeepPictures, cnt), false);
+	reader->removePictures(vis.x > pressureKeepPictures ? vis.x - pressureKeepPictures : 0, true);
+	World::drawSys()->invalidate();
+}
+
+void ProgReader::listResidents(vector<ResidentTexture>& res) {
+	ProgState::listResidents(res);
+	mvec2 vis = reader->visibleWidgets();
+	sizet margin = vis.y - vis.x;
+	for (sizet i = 0; i < reader->getWidgets().size(); ++i)
+		if (sizet dist = viewDistance(vis, i); dist > margin && reader->getPicture(i))
+			res.push_back(ResidentTexture{ reader->getPicture(i), Texture::Owner::reader, i, dist });
+}
+
+void ProgReader::evictResidents(const vector<ResidentTexture>& evs) {
+	ProgState::evictResidents(evs);
+	for (const ResidentTexture& it : evs)
+		if (it.owner == Texture::Owner::reader)
+			reader->evictPicture(it.id);
+}
+
+// evicted pages within a screen of the view get decoded again
+void ProgReader::restoreResidents() {
+	mvec2 vis = reader->visibleWidgets();
+	sizet margin = vis.y - vis.x;
+	vector<string> names;
+	for (sizet i = vis.x > margin ? vis.x - margin : 0, e = std::min(vis.y + margin, reader->getWidgets().size()); i < e; ++i)
+		if (reader->restorable(i))
+			names.push_back(reader->getPictureName(i));
+	if (!names.empty())
+		World::program()->eventReloadPictures(std::move(names));
+}
+
 void ProgReader::eventClosing() {
 	if (fs::path rpath = relativePath(World::browser()->getCurDir(), World::sets()->getDirLib()); rpath.empty())
 		World::fileSys()->saveLastPage(dotStr, World::browser()->getCurDir().u8string(), reader->curPage());
@@ -727,10 +898,10 @@ RootLayout* ProgSettings::createLayout() {
 		} }
 	});
 
-	if constexpr (Settings::rendererNames.size() > 1) {
+	if constexpr (sizet(Settings::Renderer::null) > 1) {
 		lx.push_back({ lineHeight, {
 			new Label(descLength, *itxs),
-			new ComboBox(1.f, sizet(World::sets()->renderer), vector<string>(Settings::rendererNames.begin(), Settings::rendererNames.end()), &Program::eventSetRenderer, makeTooltip("Rendering backend"))
+			new ComboBox(1.f, std::min(sizet(World::winSys()->getRenderer()), sizet(Settings::Renderer::null) - 1), vector<string>(Settings::rendererNames.begin(), Settings::rendererNames.begin() + sizet(Settings::Renderer::null)), &Program::eventSetRenderer, makeTooltip("Rendering backend"))
 		} });
 	}
 	++itxs;
@@ -853,7 +1024,14 @@ void ProgSearchDir::eventEscape() {
 
 void ProgSearchDir::eventHide() {
 	ProgState::eventHide();
-	World::scene()->resetLayouts();
+	eventDirChange();
+}
+
+void ProgSearchDir::eventDirChange() {
+	World::scene()->onMouseLeave();
+	locationBar->setText(World::browser()->getCurDir().u8string());
+	list->setWidgets(createDirItems());
+	World::scene()->updateSelect();
 }
 
 RootLayout* ProgSearchDir::createLayout() {
@@ -871,22 +1049,24 @@ RootLayout* ProgSearchDir::createLayout() {
 		new Label(lineHeight, *itxs++, &Program::eventSetLibraryDirBW)
 	};
 
-	// directory list
-	vector<fs::path> strs = FileSys::listDir(World::browser()->getCurDir(), false, true, World::sets()->showHidden);
-	vector<Widget*> items(strs.size());
-	for (sizet i = 0; i < strs.size(); ++i)
-		items[i] = new Label(lineHeight, strs[i].u8string(), nullptr, nullptr, &Program::eventBrowserGoIn, nullptr, Alignment::left, World::drawSys()->texture("folder"));
-
 	// main content
 	vector<Widget*> mid = {
 		new Layout(txsWidth, std::move(bar)),
-		list = new ScrollArea(1.f, std::move(items), Direction::down, Layout::Select::one)
+		list = new ScrollArea(1.f, createDirItems(), Direction::down, Layout::Select::one)
 	};
 
 	// root layout
 	vector<Widget*> cont = {
-		new LabelEdit(lineHeight, World::browser()->getCurDir().u8string(), &Program::eventBrowserGoTo),
+		locationBar = new LabelEdit(lineHeight, World::browser()->getCurDir().u8string(), &Program::eventBrowserGoTo),
 		new Layout(1.f, std::move(mid), Direction::right, Layout::Select::none, topSpacing)
 	};
 	return new RootLayout(1.f, std::move(cont), Direction::down, Layout::Select::none, topSpacing);
 }
+
+vector<Widget*> ProgSearchDir::createDirItems() {
+	vector<fs::path> strs = FileSys::listDir(World::browser()->getCurDir(), false, true, World::sets()->showHidden);
+	vector<Widget*> items(strs.size());
+	for (sizet i = 0; i < strs.size(); ++i)
+		items[i] = new Label(lineHeight, strs[i].u8string(), nullptr, nullptr, &Program::eventBrowserGoIn, nullptr, Alignment::left, World::drawSys()->texture("folder"));
+	return items;
+}
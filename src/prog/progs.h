@@ -1,7 +1,7 @@
 #pragma once
 
 #include "downloader.h"
-#include "utils/settings.h"
+#include "utils/layouts.h"
 
 // for handling program state specific things that occur in all states
 class ProgState {
@@ -61,8 +61,14 @@ public:
 	virtual void eventHide();
 	void eventBoss();
 	void eventRefresh();
+	void eventFrameStats();
 	virtual void eventFileDrop(const fs::path&) {}
+	virtual void eventDirChange();	// the browser's current directory changed
 	virtual void eventClosing() {}
+	virtual void eventMemoryPressure() {}	// memory is critically low, so anything out of view should be let go
+	virtual void listResidents(vector<ResidentTexture>& res);	// textures that may be evicted to stay within the texture budget
+	virtual void evictResidents(const vector<ResidentTexture>& evs);
+	virtual void restoreResidents() {}	// bring back evicted textures that are near the view again
 	void onResize();
 
 	virtual RootLayout* createLayout() = 0;
@@ -75,12 +81,15 @@ public:
 	static Recti calcTextContextRect(const vector<Widget*>& items, ivec2 pos, ivec2 size, int margin);
 protected:
 	template <class T> static int findMaxLength(T pos, T end, int height);
-	Texture* makeTooltip(const char* str);
-	Texture* makeTooltipL(const char* str);
+	Tooltip* makeTooltip(const char* str);
+	Tooltip* makeTooltipL(const char* str);
 
 	bool eventCommonEscape();	// returns true if something happened
+	static sizet viewDistance(mvec2 vis, sizet id);	// number of items between the item and the visible ones
 private:
 	void eventSelect(Direction dir);
+	static vector<Button*> tooltipOwners();
+	static void collectTooltips(Widget* wgt, vector<Button*>& buts);
 	static void calcContextPos(int& pos, int& siz, int limit);
 };
 
@@ -88,8 +97,10 @@ inline ProgState::ProgState() {
 	onResize();
 }
 
-class ProgBooks : public ProgState {
+class ProgBooks : public ProgState, public ItemProvider {
 public:
+	vector<string> books;	// names of the library's tiles, which are only created while they're in view
+
 	~ProgBooks() final = default;
 
 	void eventEscape() final;
@@ -97,19 +108,37 @@ public:
 	void eventFileDrop(const fs::path& file) final;
 
 	RootLayout* createLayout() final;
+	Widget* createItem(sizet id) final;
+	bool reuseItem(Widget* wgt, sizet id) final;
 };
 
-class ProgPageBrowser : public ProgState {
+class ProgPageBrowser : public ProgState, public ItemProvider {
 public:
 	ScrollArea* fileList;
+	LabelEdit* locationBar;
+	vector<string> entries;			// directories followed by files
+	vector<const Texture*> icons;	// folder/file icon or preview of each entry
+	sizet dirCount;
 
 	~ProgPageBrowser() final = default;
 
 	void eventEscape() final;
 	void eventHide() final;
 	void eventFileDrop(const fs::path& file) final;
+	void eventDirChange() final;
+	void eventMemoryPressure() final;
+	void listResidents(vector<ResidentTexture>& res) final;
+	void evictResidents(const vector<ResidentTexture>& evs) final;
+	void restoreResidents() final;
 
 	RootLayout* createLayout() final;
+	Widget* createItem(sizet id) final;
+	bool reuseItem(Widget* wgt, sizet id) final;
+private:
+	vector<bool> previewEvicted;	// whether an entry's preview is to be loaded again once it's near the view
+	vector<Size> loadEntries();
+	void evictPreview(sizet id);
+	static string locationText();
 };
 
 class ProgReader : public ProgState {
@@ -117,6 +146,7 @@ public:
 	ReaderBox* reader;
 private:
 	static constexpr float scrollFactor = 2.f;
+	static constexpr sizet pressureKeepPictures = 2;	// pictures kept on either side of the view when memory runs low
 
 public:
 	~ProgReader() final = default;
@@ -142,6 +172,10 @@ public:
 	void eventPrevDir() final;
 	void eventHide() final;
 	void eventClosing() final;
+	void eventMemoryPressure() final;
+	void listResidents(vector<ResidentTexture>& res) final;
+	void evictResidents(const vector<ResidentTexture>& evs) final;
+	void restoreResidents() final;
 
 	RootLayout* createLayout() final;
 	Overlay* createOverlay() final;
@@ -217,11 +251,15 @@ inline u32vec2 ProgSettings::getDvice(sizet id) const {
 class ProgSearchDir : public ProgState {
 public:
 	ScrollArea* list;
+	LabelEdit* locationBar;
 
 	~ProgSearchDir() final = default;
 
 	void eventEscape() final;
 	void eventHide() final;
+	void eventDirChange() final;
 
 	RootLayout* createLayout() final;
+private:
+	vector<Widget*> createDirItems();
 };
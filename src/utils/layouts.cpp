@@ -22,7 +22,8 @@ Layout::~Layout() {
 
 void Layout::drawSelf(const Recti& view) {
 	for (Widget* it : widgets)
-		it->drawSelf(view);
+		if (it)
+			it->drawSelf(view);
 }
 
 void Layout::drawAddr(const Recti& view) {
@@ -32,18 +33,15 @@ void Layout::drawAddr(const Recti& view) {
 void Layout::onResize() {
 	calculateWidgetPositions();
 	for (Widget* it : widgets)
-		it->onResize();
-}
-
-void Layout::tick(float dSec) {
-	for (Widget* it : widgets)
-		it->tick(dSec);
+		if (it)
+			it->onResize();
 }
 
 void Layout::postInit() {
 	calculateWidgetPositions();
 	for (Widget* it : widgets)
-		it->postInit();
+		if (it)
+			it->postInit();
 }
 
 void Layout::calculateWidgetPositions() {
@@ -55,7 +53,7 @@ void Layout::calculateWidgetPositions() {
 	int space = wsiz[vi] - (widgets.size() - 1) * spacing;
 	float total = 0;
 	for (sizet i = 0; i < widgets.size(); ++i)
-		switch (const Size& siz = widgets[i]->getRelSize(); siz.mod) {
+		switch (const Size& siz = wgtRelSize(i); siz.mod) {
 		case Size::rela:
 			total += siz.prc;
 			break;
@@ -72,7 +70,7 @@ void Layout::calculateWidgetPositions() {
 	ivec2 pos(pad);
 	for (sizet i = 0; i < widgets.size(); ++i) {
 		positions[i] = pos;
-		if (const Size& siz = widgets[i]->getRelSize(); siz.mod != Size::rela)
+		if (const Size& siz = wgtRelSize(i); siz.mod != Size::rela)
 			pos[vi] += pixSizes[i] + spacing;
 		else if (float val = siz.prc * float(space); val != 0.f)
 			pos[vi] += int(val / total) + spacing;
@@ -80,14 +78,10 @@ void Layout::calculateWidgetPositions() {
 	positions.back() = vswap(wsiz[!vi], pos[vi], !vi);
 }
 
-void Layout::onMouseMove(ivec2 mPos, ivec2 mMov) {
-	for (Widget* it : widgets)
-		it->onMouseMove(mPos, mMov);
-}
-
 void Layout::onDisplayChange() {
 	for (Widget* it : widgets)
-		it->onDisplayChange();
+		if (it)
+			it->onDisplayChange();
 }
 
 bool Layout::navSelectable() const {
@@ -109,7 +103,7 @@ void Layout::navSelectFrom(int mid, Direction dir) {
 }
 
 void Layout::scanSequential(sizet id, int mid, Direction dir) {
-	for (sizet mov = btom<sizet>(dir.positive()); (id += mov) < widgets.size() && !widgets[id]->navSelectable(););
+	for (sizet mov = btom<sizet>(dir.positive()); (id += mov) < widgets.size() && !wgtNavSelectable(id););
 	if (id < widgets.size())
 		navSelectWidget(id, mid, dir);
 	else if (parent)
@@ -118,9 +112,9 @@ void Layout::scanSequential(sizet id, int mid, Direction dir) {
 
 void Layout::scanPerpendicular(int mid, Direction dir) {
 	sizet id = 0;
-	for (uint hori = dir.horizontal(); id < widgets.size() && (!widgets[id]->navSelectable() || (wgtPosition(id)[hori] + wgtSize(id)[hori] < mid)); ++id);
+	for (uint hori = dir.horizontal(); id < widgets.size() && (!wgtNavSelectable(id) || (wgtPosition(id)[hori] + wgtSize(id)[hori] < mid)); ++id);
 	if (id == widgets.size())
-		while (--id < widgets.size() && !widgets[id]->navSelectable());
+		while (--id < widgets.size() && !wgtNavSelectable(id));
 
 	if (id < widgets.size())
 		navSelectWidget(id, mid, dir);
@@ -129,10 +123,11 @@ void Layout::scanPerpendicular(int mid, Direction dir) {
 }
 
 void Layout::navSelectWidget(sizet id, int mid, Direction dir) {
-	if (Layout* lay = dynamic_cast<Layout*>(widgets[id]))
+	Widget* wgt = loadWidget(id);
+	if (Layout* lay = dynamic_cast<Layout*>(wgt))
 		lay->navSelectFrom(mid, dir);
-	else if (widgets[id]->navSelectable())
-		World::scene()->select = widgets[id];
+	else if (wgt->navSelectable())
+		World::scene()->select = wgt;
 }
 
 void Layout::initWidgets(vector<Widget*>&& wgts) {
@@ -150,6 +145,7 @@ void Layout::clearWidgets() {
 	for (Widget* it : widgets)
 		delete it;
 	widgets.clear();
+	selected.clear();
 }
 
 void Layout::setWidgets(vector<Widget*>&& wgts) {
@@ -164,7 +160,7 @@ void Layout::setWidgets(vector<Widget*>&& wgts) {
 
 bool Layout::anyWidgetsNavSelected(Layout* box) {
 	for (Widget* it : box->widgets) {
-		if (World::scene()->select == it)
+		if (it && World::scene()->select == it)
 			return true;
 		if (Layout* lay = dynamic_cast<Layout*>(it); lay && anyWidgetsNavSelected(lay))
 			return true;
@@ -184,12 +180,14 @@ void Layout::replaceWidget(sizet id, Widget* widget) {
 
 void Layout::deleteWidget(sizet id) {
 	bool updateSelect = World::scene()->select == widgets[id];
+	selected.erase(widgets[id]);
 	delete widgets[id];
 	widgets.erase(widgets.begin() + pdift(id));
 	positions.pop_back();
 
 	for (sizet i = id; i < widgets.size(); ++i)
-		widgets[i]->setParent(this, i);
+		if (widgets[i])
+			widgets[i]->setParent(this, i);
 	postInit();
 	if (updateSelect) {
 		World::scene()->select = nullptr;
@@ -332,8 +330,25 @@ void Context::setRect(const Recti& rct) {
 
 // SCROLL AREA
 
+ScrollArea::ScrollArea(const Size& size, vector<Size>&& itemSizes, ItemProvider* itemProvider, Direction dir, Select select, int space, bool pad) :
+	Layout(size, vector<Widget*>(), dir, select, space, pad),
+	items(std::move(itemSizes)),
+	provider(itemProvider)
+{
+	widgets.resize(items.size(), nullptr);
+	positions.resize(items.size() + 1);
+}
+
+ScrollArea::~ScrollArea() {
+	World::scene()->unsubscribe(this);
+	for (Widget* it : spares)
+		delete it;
+}
+
 void ScrollArea::drawSelf(const Recti& view) {
+	loadVisible();
 	World::drawSys()->drawScrollArea(this, view);
+	releaseHidden();
 }
 
 void ScrollArea::onResize() {
@@ -342,14 +357,15 @@ void ScrollArea::onResize() {
 }
 
 void ScrollArea::tick(float dSec) {
-	Layout::tick(dSec);
-
 	if (motion.x != 0.f || motion.y != 0.f) {
 		moveListPos(motion);
 		throttleMotion(motion.x, dSec);
 		throttleMotion(motion.y, dSec);
 		World::scene()->updateSelect();
+		World::drawSys()->invalidate();
 	}
+	if (!animating())
+		World::scene()->unsubscribeTick(this);
 }
 
 void ScrollArea::postInit() {
@@ -372,6 +388,7 @@ void ScrollArea::onHold(ivec2 mPos, uint8 mBut) {
 }
 
 void ScrollArea::onDrag(ivec2 mPos, ivec2 mMov) {
+	World::drawSys()->invalidate(this);
 	if (draggingSlider)
 		setSlider(mPos.y - diffSliderMouse);
 	else if (SDL_GetMouseState(nullptr, nullptr) & SDL_BUTTON(SDL_BUTTON_RIGHT))
@@ -382,8 +399,10 @@ void ScrollArea::onDrag(ivec2 mPos, ivec2 mMov) {
 
 void ScrollArea::onUndrag(uint8 mBut) {
 	if (mBut == SDL_BUTTON_LEFT) {
-		if (!World::scene()->cursorInClickRange(World::winSys()->mousePos(), mBut) && !draggingSlider)
+		if (!World::scene()->cursorInClickRange(World::winSys()->mousePos(), mBut) && !draggingSlider) {
 			motion = World::inputSys()->getMouseMove() * vswap(0, -1, direction.horizontal());
+			World::scene()->subscribeTick(this);
+		}
 
 		draggingSlider = false;
 		World::scene()->setCapture(nullptr);
@@ -411,9 +430,9 @@ void ScrollArea::scrollToSelected() {
 		return;
 
 	uint di = direction.vertical();
-	if (int cpos = widgets[cid]->position()[di], fpos = position()[di]; cpos < fpos)
+	if (int cpos = wgtPosition(cid)[di], fpos = position()[di]; cpos < fpos)
 		scrollToWidgetPos(cid);
-	else if (cpos + widgets[cid]->size()[di] > fpos + size()[di])
+	else if (cpos + wgtSize(cid)[di] > fpos + size()[di])
 		scrollToWidgetEnd(cid);
 }
 
@@ -473,6 +492,35 @@ void ScrollArea::scrollToLimit(bool start) {
 	motion = vec2(0.f);
 }
 
+Widget* ScrollArea::loadWidget(sizet id) {
+	if (!widgets[id] && provider) {
+		if (vector<Widget*>::reverse_iterator it = std::find_if(spares.rbegin(), spares.rend(), [this, id](Widget* wgt) -> bool { return provider->reuseItem(wgt, id); }); it != spares.rend()) {
+			widgets[id] = *it;
+			spares.erase(std::next(it).base());
+		} else
+			widgets[id] = provider->createItem(id);
+		widgets[id]->setParent(this, id);
+		widgets[id]->postInit();
+		cached = cached.x < cached.y ? mvec2(std::min(cached.x, id), std::max(cached.y, id + 1)) : mvec2(id, id + 1);
+	}
+	return widgets[id];
+}
+
+void ScrollArea::setItems(vector<Size>&& itemSizes) {
+	clearWidgets();
+	items = std::move(itemSizes);
+	widgets.resize(items.size(), nullptr);
+	positions.resize(items.size() + 1);
+	cached = mvec2(0);
+	postInit();
+}
+
+void ScrollArea::deleteWidget(sizet id) {
+	if (provider)
+		items.erase(items.begin() + pdift(id));
+	Layout::deleteWidget(id);
+}
+
 Recti ScrollArea::frame() const {
 	return parent ? rect().intersect(parent->frame()) : rect();
 }
@@ -509,6 +557,14 @@ int ScrollArea::wgtREnd(sizet id) const {
 	return positions[id + 1][direction.vertical()] - spacing;
 }
 
+const Size& ScrollArea::wgtRelSize(sizet id) const {
+	return provider ? items[id] : Layout::wgtRelSize(id);
+}
+
+bool ScrollArea::animating() const {
+	return motion.x != 0.f || motion.y != 0.f;
+}
+
 int ScrollArea::sliderPos() const {
 	int di = direction.vertical();
 	return listSize()[di] > size()[di] ? position()[di] + listPos[di] * sliderLim() / listLim()[di] : position()[di];
@@ -544,16 +600,54 @@ Recti ScrollArea::sliderRect() const {
 	return direction.vertical() ? Recti(position().x + size().x - bs, sliderPos(), bs, sliderSize()) : Recti(sliderPos(), position().y + size().y - bs, sliderSize(), bs);
 }
 
+void ScrollArea::loadVisible() {
+	if (provider)
+		for (mvec2 vis = visibleWidgets(); vis.x < vis.y; ++vis.x)
+			loadWidget(vis.x);
+}
+
+void ScrollArea::releaseHidden() {
+	// keep a screen's worth of widgets on either side, everything past that is set aside for whichever item comes into view next
+	mvec2 vis = visibleWidgets();
+	sizet margin = vis.y - vis.x;
+	mvec2 keep(vis.x > margin ? vis.x - margin : 0, std::min(vis.y + margin, widgets.size()));
+	for (sizet i = cached.x, e = std::min(cached.y, widgets.size()); i < e; ++i)
+		if ((i < keep.x || i >= keep.y) && widgets[i]) {
+			widgets[i]->releaseCache();
+			if (provider && !isPinned(widgets[i])) {
+				spares.push_back(widgets[i]);
+				widgets[i] = nullptr;
+			}
+		}
+	cached = mvec2(std::max(std::min(cached.x, vis.x), keep.x), std::min(std::max(cached.y, vis.y), keep.y));
+}
+
+bool ScrollArea::isPinned(Widget* wgt) const {
+	// widgets that the scene or the selection still refer to have to keep their item
+	Scene* scene = World::scene();
+	return selected.count(wgt) || scene->select == wgt || scene->getCapture() == wgt || (scene->getContext() && scene->getContext()->owner() == wgt);
+}
+
 mvec2 ScrollArea::visibleWidgets() const {
 	mvec2 ival(0);
 	if (widgets.empty())	// nothing to draw
 		return ival;
 
+	// widget offsets only ever grow along the list, so both ends can be found by bisection
 	int di = direction.vertical();
-	for (; ival.x < widgets.size() && wgtREnd(ival.x) < listPos[di]; ++ival.x);
+	for (sizet hi = widgets.size(); ival.x < hi;)
+		if (sizet mid = (ival.x + hi) / 2; wgtREnd(mid) < listPos[di])
+			ival.x = mid + 1;
+		else
+			hi = mid;
 
 	ival.y = ival.x + 1;	// last is one greater than the actual last index
-	for (int end = listPos[di] + size()[di]; ival.y < widgets.size() && wgtRPos(ival.y) <= end; ++ival.y);
+	int end = listPos[di] + size()[di];
+	for (sizet hi = widgets.size(); ival.y < hi;)
+		if (sizet mid = (ival.y + hi) / 2; wgtRPos(mid) <= end)
+			ival.y = mid + 1;
+		else
+			hi = mid;
 	return ival;
 }
 
@@ -564,15 +658,20 @@ TileBox::TileBox(const Size& size, vector<Widget*>&& children, int childHeight,
 	wheight(childHeight)
 {}
 
+TileBox::TileBox(const Size& size, vector<Size>&& itemSizes, ItemProvider* itemProvider, int childHeight, Select select, int space, bool pad) :
+	ScrollArea(size, std::move(itemSizes), itemProvider, Direction::down, select, space, pad),
+	wheight(childHeight)
+{}
+
 void TileBox::calculateWidgetPositions() {
 	positions[0] = ivec2(0);
 	int wsiz = size()[direction.horizontal()] - Slider::barSize;
-	ivec2 pos(!widgets.empty() ? widgets[0]->sizeToPixAbs(widgets[0]->getRelSize(), wsiz) + spacing : 0, 0);
+	ivec2 pos(!widgets.empty() ? sizeToPixAbs(wgtRelSize(0), wsiz) + spacing : 0, 0);
 	for (sizet i = 1; i < widgets.size(); ++i) {
-		if (int end = pos.x + widgets[i]->sizeToPixAbs(widgets[i]->getRelSize(), wsiz); end > wsiz && positions[i - 1].y == pos.y) {
+		if (int end = pos.x + sizeToPixAbs(wgtRelSize(i), wsiz); end > wsiz && positions[i - 1].y == pos.y) {
 			pos = ivec2(0, pos.y + wheight + spacing);
 			positions[i] = pos;
-			pos.x += widgets[i]->getRelSize().pix + spacing;
+			pos.x += wgtRelSize(i).pix + spacing;
 		} else {
 			positions[i] = pos;
 			pos.x = end + spacing;
@@ -598,16 +697,16 @@ void TileBox::navSelectFrom(int mid, Direction dir) {
 }
 
 void TileBox::scanVertically(sizet id, int mid, Direction dir) {
-	if (int ypos = widgets[id]->position().y; dir.positive())
-		while (++id < widgets.size() && (!widgets[id]->navSelectable() || widgets[id]->position().y == ypos || widgets[id]->position().x + widgets[id]->size().x < mid));
+	if (int ypos = wgtPosition(id).y; dir.positive())
+		while (++id < widgets.size() && (!wgtNavSelectable(id) || wgtPosition(id).y == ypos || wgtPosition(id).x + wgtSize(id).x < mid));
 	else
-		while (--id < widgets.size() && (!widgets[id]->navSelectable() || widgets[id]->position().y == ypos || widgets[id]->position().x > mid));
+		while (--id < widgets.size() && (!wgtNavSelectable(id) || wgtPosition(id).y == ypos || wgtPosition(id).x > mid));
 	navSelectIfInRange(id, mid, dir);
 }
 
 void TileBox::scanHorizontally(sizet id, int mid, Direction dir) {
-	for (sizet mov = btom<sizet>(dir.positive()); (id += mov) < widgets.size() && !widgets[id]->navSelectable(););
-	if (id < widgets.size() && widgets[id]->center().y == mid)
+	for (sizet mov = btom<sizet>(dir.positive()); (id += mov) < widgets.size() && !wgtNavSelectable(id););
+	if (id < widgets.size() && wgtPosition(id).y + wgtSize(id).y / 2 == mid)
 		navSelectWidget(id, mid, dir);
 	else if (parent)
 		parent->navSelectNext(index, mid, dir);
@@ -615,13 +714,13 @@ void TileBox::scanHorizontally(sizet id, int mid, Direction dir) {
 
 void TileBox::scanFromStart(int mid, Direction dir) {
 	sizet id = 0;
-	for (uint di = dir != Direction::down; id < widgets.size() && (!widgets[id]->navSelectable() || widgets[id]->position()[di] + widgets[id]->size()[di] < mid); ++id);
+	for (uint di = dir != Direction::down; id < widgets.size() && (!wgtNavSelectable(id) || wgtPosition(id)[di] + wgtSize(id)[di] < mid); ++id);
 	navSelectIfInRange(id, mid, dir);
 }
 
 void TileBox::scanFromEnd(int mid, Direction dir) {
 	sizet id = widgets.size() - 1;
-	for (uint di = dir != Direction::up; id < widgets.size() && (!widgets[id]->navSelectable() || widgets[id]->position()[di] > mid); --id);
+	for (uint di = dir != Direction::up; id < widgets.size() && (!wgtNavSelectable(id) || wgtPosition(id)[di] > mid); --id);
 	navSelectIfInRange(id, mid, dir);
 }
 
@@ -633,7 +732,7 @@ void TileBox::navSelectIfInRange(sizet id, int mid, Direction dir) {
 }
 
 ivec2 TileBox::wgtSize(sizet id) const {
-	return ivec2(widgets[id]->getRelSize().pix, wheight);
+	return ivec2(wgtRelSize(id).pix, wheight);
 }
 
 int TileBox::wgtREnd(sizet id) const {
@@ -644,12 +743,14 @@ int TileBox::wgtREnd(sizet id) const {
 
 ReaderBox::ReaderBox(const Size& size, Direction dir, float fzoom, int space, bool pad) :
 	ScrollArea(size, {}, dir, Select::none, space, pad),
+	offsets(1, 0),
 	zoom(fzoom)
 {}
 
 ReaderBox::~ReaderBox() {
 	for (auto& [name, tex] : pics)
-		World::drawSys()->freeTexture(tex);
+		if (tex)
+			World::drawSys()->freeTexture(tex);
 }
 
 void ReaderBox::drawSelf(const Recti& view) {
@@ -670,6 +771,9 @@ void ReaderBox::tick(float dSec) {
 
 void ReaderBox::postInit() {
 	ScrollArea::postInit();
+	World::scene()->subscribeMouseMove(this);	// the cursor has to reappear wherever it moves
+	if (countDown)
+		World::scene()->subscribeTick(this);
 
 	// scroll down to opened picture if it exists, otherwise start at beginning
 	string file = World::browser()->getCurFile().u8string();
@@ -683,48 +787,95 @@ void ReaderBox::postInit() {
 }
 
 void ReaderBox::calculateWidgetPositions() {
-	// figure out the width of the list
-	int hi = direction.horizontal();
-	int maxRSiz = size()[hi];
-	for (const pair<string, Texture*>& it : pics)
-		if (int rsiz = int(float(it.second->getRes()[hi]) * zoom); rsiz > maxRSiz)
-			maxRSiz = rsiz;
-
-	// set position of each picture
-	int rpos = 0;
-	for (sizet i = 0; i < widgets.size(); ++i) {
-		ivec2 psz = vec2(pics[i].second->getRes()) * zoom;
-		positions[i] = vswap((maxRSiz - psz[hi]) / 2, rpos, hi);
-		rpos += psz[!hi];
-	}
-	positions.back() = vswap(maxRSiz, rpos, hi);
+	// positions are derived from offsets, which only change when pictures are added or removed
 }
 
 void ReaderBox::onMouseMove(ivec2 mPos, ivec2 mMov) {
-	Layout::onMouseMove(mPos, mMov);
+	if (Recti bar = barRect(); bar.contains(mPos) != bar.contains(mPos - mMov))
+		World::drawSys()->invalidate(bar);
 
 	countDown = World::scene()->getSelectedScrollArea() == this && !showBar() && World::scene()->getCapture() != this && cursorTimer > 0.f;
 	if (cursorTimer < menuHideTimeout) {
 		cursorTimer = menuHideTimeout;
 		SDL_ShowCursor(SDL_ENABLE);
 	}
+	if (countDown)
+		World::scene()->subscribeTick(this);
 }
 
 void ReaderBox::setWidgets(vector<pair<string, Texture*>>&& imgs) {
 	clearWidgets();
-	pics = std::move(imgs);
+	lostPics.clear();
+	pics.assign(std::make_move_iterator(imgs.begin()), std::make_move_iterator(imgs.end()));
 	widgets.resize(pics.size());
-	positions.resize(pics.size()+1);
+	breadths.resize(pics.size());
+	offsets.assign(1, 0);
 
 	if (direction.negative())
 		std::reverse(pics.begin(), pics.end());
+	int vi = direction.vertical();
 	for (sizet i = 0; i < pics.size(); ++i) {
 		widgets[i] = new Picture(0, false, pics[i].second, 0);
 		widgets[i]->setParent(this, i);
+		breadths[i] = pics[i].second->getRes()[!vi];
+		offsets.push_back(offsets.back() + pics[i].second->getRes()[vi]);
 	}
+	updateMaxBreadth();
 	postInit();
 }
 
+void ReaderBox::removePictures(sizet cnt, bool front) {
+	cnt = std::min(cnt, pics.size());
+	int vi = direction.vertical();
+	int shift = front ? wgtRPos(cnt) : 0;
+	bool widest = false;
+	for (sizet i = front ? 0 : pics.size() - cnt, e = i + cnt; i < e; ++i) {
+		widest |= breadths[i] >= maxBreadth;
+		if (pics[i].second)
+			World::drawSys()->freeTexture(pics[i].second);
+		delete widgets[i];
+	}
+
+	if (front) {
+		pics.erase(pics.begin(), pics.begin() + pdift(cnt));
+		breadths.erase(breadths.begin(), breadths.begin() + pdift(cnt));
+		offsets.erase(offsets.begin(), offsets.begin() + pdift(cnt));
+		widgets.erase(widgets.begin(), widgets.begin() + pdift(cnt));
+		for (sizet i = 0; i < widgets.size(); ++i)
+			widgets[i]->setParent(this, i);
+		listPos[vi] -= shift;
+	} else {
+		pics.erase(pics.end() - pdift(cnt), pics.end());
+		breadths.erase(breadths.end() - pdift(cnt), breadths.end());
+		offsets.erase(offsets.end() - pdift(cnt), offsets.end());
+		widgets.erase(widgets.end() - pdift(cnt), widgets.end());
+	}
+	if (widest)
+		updateMaxBreadth();
+	listPos = glm::clamp(listPos, ivec2(0), listLim());
+}
+
+void ReaderBox::evictPicture(sizet id) {
+	if (pics[id].second) {
+		World::drawSys()->freeTexture(pics[id].second);
+		pics[id].second = nullptr;
+		static_cast<Picture*>(widgets[id])->tex = nullptr;
+	}
+}
+
+// returns false if there's no evicted picture of that name left to take the texture
+bool ReaderBox::restorePicture(const string& name, Texture* tex) {
+	deque<pair<string, Texture*>>::iterator it = std::find_if(pics.begin(), pics.end(), [&name](const pair<string, Texture*>& pic) -> bool { return !pic.second && pic.first == name; });
+	if (it == pics.end())
+		return false;
+
+	sizet id = it - pics.begin();
+	it->second = tex;
+	static_cast<Picture*>(widgets[id])->tex = tex;
+	World::drawSys()->invalidate(widgets[id]);
+	return true;
+}
+
 bool ReaderBox::showBar() const {
 	return barRect().contains(World::winSys()->mousePos()) || draggingSlider;
 }
@@ -732,8 +883,7 @@ bool ReaderBox::showBar() const {
 void ReaderBox::setZoom(float factor) {
 	ivec2 sh = size() / 2;
 	zoom *= factor;
-	listPos = glm::clamp(ivec2(vec2(listPos + sh) * factor) - sh, ivec2(0), listLim());
-	onResize();
+	listPos = glm::clamp(ivec2(glm::dvec2(listPos + sh) * double(factor)) - sh, ivec2(0), listLim());
 }
 
 void ReaderBox::centerList() {
@@ -742,21 +892,41 @@ void ReaderBox::centerList() {
 }
 
 ivec2 ReaderBox::wgtPosition(sizet id) const {
-	return position() + positions[id] + vswap(0, int(id) * spacing, direction.horizontal()) - listPos;
+	return position() + vswap((listBreadth() - pictureBreadth(id)) / 2, wgtRPos(id), direction.horizontal()) - listPos;
 }
 
 ivec2 ReaderBox::wgtSize(sizet id) const {
-	return vec2(pics[id].second->getRes()) * zoom;
+	return vswap(pictureBreadth(id), wgtREnd(id) - wgtRPos(id), direction.horizontal());
 }
 
 ivec2 ReaderBox::listSize() const {
-	return positions.back() + vswap(0, int(widgets.size() - 1) * spacing, direction.horizontal());
+	return vswap(listBreadth(), zoomOffset(pics.size()) + int(widgets.size() - 1) * spacing, direction.horizontal());
 }
 
 int ReaderBox::wgtRPos(sizet id) const {
-	return positions[id][direction.vertical()] + id * spacing;
+	return zoomOffset(id) + id * spacing;
 }
 
 int ReaderBox::wgtREnd(sizet id) const {
-	return positions[id + 1][direction.vertical()] + id * spacing;
+	return zoomOffset(id + 1) + id * spacing;
+}
+
+bool ReaderBox::animating() const {
+	return ScrollArea::animating() || countDown;
+}
+
+int ReaderBox::listBreadth() const {
+	return std::max(size()[direction.horizontal()], int(double(maxBreadth) * double(zoom)));
+}
+
+int ReaderBox::zoomOffset(sizet id) const {
+	return int(double(offsets[id] - offsets.front()) * double(zoom));
+}
+
+int ReaderBox::pictureBreadth(sizet id) const {
+	return int(double(breadths[id]) * double(zoom));
+}
+
+void ReaderBox::updateMaxBreadth() {
+	maxBreadth = breadths.empty() ? 0 : *std::max_element(breadths.begin(), breadths.end());
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "widgets.h"
+#include <deque>
+
+using std::deque;
 
 // container for other widgets
 class Layout : public Widget {
@@ -30,9 +33,7 @@ public:
 	void drawSelf(const Recti& view) override;
 	void drawAddr(const Recti& view) override;
 	void onResize() override;
-	void tick(float dSec) override;
 	void postInit() override;
-	void onMouseMove(ivec2 mPos, ivec2 mMov) override;
 	void onDisplayChange() override;
 	void onNavSelect(Direction) override {}
 	bool navSelectable() const override;
@@ -40,11 +41,12 @@ public:
 	virtual void navSelectNext(sizet id, int mid, Direction dir);
 	virtual void navSelectFrom(int mid, Direction dir);
 
-	Widget* getWidget(sizet id) const;
+	Widget* getWidget(sizet id) const;	// may be null for items of a virtual ScrollArea that aren't in view
+	virtual Widget* loadWidget(sizet id);	// like getWidget but creates the widget first if necessary
 	const vector<Widget*>& getWidgets() const;
 	void setWidgets(vector<Widget*>&& wgts);	// not suitable for using on a ReaderBox, use the overload
 	void replaceWidget(sizet id, Widget* widget);
-	void deleteWidget(sizet id);
+	virtual void deleteWidget(sizet id);
 	const uset<Widget*>& getSelected() const;
 	virtual ivec2 wgtPosition(sizet id) const;
 	virtual ivec2 wgtSize(sizet id) const;
@@ -58,6 +60,8 @@ protected:
 	void clearWidgets();
 	virtual void calculateWidgetPositions();
 	virtual ivec2 listSize() const;
+	virtual const Size& wgtRelSize(sizet id) const;
+	bool wgtNavSelectable(sizet id) const;
 
 	void navSelectWidget(sizet id, int mid, Direction dir);
 private:
@@ -72,6 +76,10 @@ inline Widget* Layout::getWidget(sizet id) const {
 	return widgets[id];
 }
 
+inline Widget* Layout::loadWidget(sizet id) {
+	return widgets[id];
+}
+
 inline const vector<Widget*>& Layout::getWidgets() const {
 	return widgets;
 }
@@ -80,6 +88,14 @@ inline const uset<Widget*>& Layout::getSelected() const {
 	return selected;
 }
 
+inline const Size& Layout::wgtRelSize(sizet id) const {
+	return widgets[id]->getRelSize();
+}
+
+inline bool Layout::wgtNavSelectable(sizet id) const {
+	return widgets[id] ? widgets[id]->navSelectable() : true;	// model items are always meant to be clicked
+}
+
 inline void Layout::deselectWidget(sizet id) {
 	selected.erase(widgets[id]);
 }
@@ -161,19 +177,34 @@ inline T* Context::owner() const {
 }
 
 // places widgets vertically through which the user can scroll (DON"T PUT SCROLL AREAS INTO OTHER SCROLL AREAS)
+// makes the widgets of a virtual list and gives ones that went out of view another item to show
+class ItemProvider {
+public:
+	virtual ~ItemProvider() = default;
+
+	virtual Widget* createItem(sizet id) = 0;
+	virtual bool reuseItem(Widget* wgt, sizet id) = 0;	// returns false if the widget can't show that item
+};
+
+// in virtual mode only the sizes of the items are known up front and widgets are made by the provider while they're near the view
 class ScrollArea : public Layout {
 protected:
 	bool draggingSlider = false;
 	ivec2 listPos = ivec2(0);
 private:
 	vec2 motion = vec2(0.f);	// how much the list scrolls over time
+	mvec2 cached = mvec2(0);	// index interval of widgets that may hold data for drawing
 	int diffSliderMouse = 0;	// space between slider and mouse position
+	vector<Size> items;			// sizes of the model's items in virtual mode (can't be Size::calc)
+	vector<Widget*> spares;		// widgets that went out of view in virtual mode and wait for another item
+	ItemProvider* provider = nullptr;	// makes the widgets in virtual mode
 
 	static constexpr float scrollThrottle = 10.f;
 
 public:
 	using Layout::Layout;
-	~ScrollArea() override = default;
+	ScrollArea(const Size& size, vector<Size>&& itemSizes, ItemProvider* itemProvider, Direction dir = defaultDirection, Select select = Select::none, int space = defaultItemSpacing, bool pad = false);
+	~ScrollArea() override;
 
 	void drawSelf(const Recti& view) override;
 	void onResize() override;
@@ -192,6 +223,9 @@ public:
 	bool scrollToPrevious();			// scroll to previous widget (returns false if at scroll limit)
 	void scrollToLimit(bool start);		// scroll to start or end of the list relative to it's direction
 
+	Widget* loadWidget(sizet id) override;
+	void deleteWidget(sizet id) override;
+	void setItems(vector<Size>&& itemSizes);	// swap the model of a virtual list
 	Recti frame() const override;
 	ivec2 wgtPosition(sizet id) const override;
 	ivec2 wgtSize(sizet id) const override;
@@ -202,12 +236,17 @@ public:
 
 protected:
 	void scrollToSelected();
+	virtual bool animating() const;	// whether the widget still needs ticks
 	virtual ivec2 listLim() const;	// max list position
 	virtual int wgtRPos(sizet id) const;
 	virtual int wgtREnd(sizet id) const;
+	const Size& wgtRelSize(sizet id) const override;
 
 private:
 	void scrollToFollowing(sizet id, bool prev);
+	void loadVisible();
+	void releaseHidden();
+	bool isPinned(Widget* wgt) const;
 	void setSlider(int spos);
 	int barSize() const;	// returns 0 if slider isn't needed
 	int sliderSize() const;
@@ -233,6 +272,7 @@ private:
 
 public:
 	TileBox(const Size& size = Size(), vector<Widget*>&& children = vector<Widget*>(), int childHeight = defaultItemHeight, Direction dir = defaultDirection, Select select = Select::none, int space = defaultItemSpacing, bool pad = false);
+	TileBox(const Size& size, vector<Size>&& itemSizes, ItemProvider* itemProvider, int childHeight = defaultItemHeight, Select select = Select::none, int space = defaultItemSpacing, bool pad = false);
 	~TileBox() final = default;
 
 	void navSelectNext(sizet id, int mid, Direction dir) final;
@@ -258,7 +298,11 @@ private:
 	static constexpr float menuHideTimeout = 3.f;
 	static inline const string emptyFile;
 
-	vector<pair<string, Texture*>> pics;	// textures should be freed externally
+	deque<pair<string, Texture*>> pics;	// textures are null while evicted
+	deque<int> breadths;	// unzoomed size of each picture across the list
+	uset<string> lostPics;	// evicted pictures that couldn't be loaded again
+	deque<int> offsets;	// unzoomed start of each picture along the list and the end of the last one (relative to an arbitrary origin)
+	int maxBreadth = 0;	// unzoomed size of the widest picture across the list
 	float cursorTimer = menuHideTimeout;	// time left until cursor/overlay disappears
 	float zoom;
 	bool countDown = true;	// whether to decrease cursorTimer until cursor hide
@@ -273,6 +317,13 @@ public:
 	void onMouseMove(ivec2 mPos, ivec2 mMov) final;
 
 	void setWidgets(vector<pair<string, Texture*>>&& imgs);
+	void removePictures(sizet cnt, bool front);	// O(cnt) at the back, but dropping from the front renumbers every remaining picture
+	const Texture* getPicture(sizet id) const;
+	const string& getPictureName(sizet id) const;
+	void evictPicture(sizet id);	// the picture keeps its place in the list without a texture
+	bool restorePicture(const string& name, Texture* tex);
+	void losePicture(const string& name);	// stop trying to bring it back
+	bool restorable(sizet id) const;
 	bool showBar() const;
 	float getZoom() const;
 	void setZoom(float factor);
@@ -288,8 +339,29 @@ private:
 	ivec2 listSize() const final;
 	int wgtRPos(sizet id) const final;
 	int wgtREnd(sizet id) const final;
+	bool animating() const final;
+	int listBreadth() const;
+	int zoomOffset(sizet id) const;
+	int pictureBreadth(sizet id) const;
+	void updateMaxBreadth();
 };
 
+inline const Texture* ReaderBox::getPicture(sizet id) const {
+	return pics[id].second;
+}
+
+inline const string& ReaderBox::getPictureName(sizet id) const {
+	return pics[id].first;
+}
+
+inline void ReaderBox::losePicture(const string& name) {
+	lostPics.insert(name);
+}
+
+inline bool ReaderBox::restorable(sizet id) const {
+	return !pics[id].second && !lostPics.count(pics[id].first);
+}
+
 inline float ReaderBox::getZoom() const {
 	return zoom;
 }
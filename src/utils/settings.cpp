@@ -116,6 +116,10 @@ void Binding::reset(Type newType) {
 		bcall = &ProgState::eventRefresh;
 		setKey(SDL_SCANCODE_F5);
 		break;
+	case Type::frameStats:
+		bcall = &ProgState::eventFrameStats;
+		setKey(SDL_SCANCODE_F3);
+		break;
 	case Type::scrollUp:
 		acall = &ProgState::eventScrollUp;
 		setKey(SDL_SCANCODE_UP);
@@ -96,6 +96,7 @@ public:
 		hide,
 		boss,
 		refresh,
+		frameStats,
 		scrollUp,	// axis (hold down) bindings start here
 		scrollDown,
 		scrollLeft,
@@ -129,6 +130,7 @@ public:
 		"show_hidden",
 		"boss",
 		"refresh",
+		"frame_stats",
 		"scroll_up",
 		"scroll_down",
 		"scroll_left",
@@ -371,6 +373,7 @@ public:
 	void setCount(string_view str);
 	uptrt getSize() const;
 	void setSize(string_view str);
+	void setSize(uptrt bytes);
 	void set(string_view str);
 
 	static uint8 memSizeMag(uptrt num);
@@ -399,6 +402,10 @@ inline void PicLim::setSize(string_view str) {
 	size = toSize(str);
 }
 
+inline void PicLim::setSize(uptrt bytes) {
+	size = bytes;
+}
+
 inline uptrt PicLim::defaultSize() {
 	return SDL_GetSystemRAM() / 2 * 1'000'000;
 }
@@ -451,6 +458,8 @@ public:
 #ifdef WITH_VULKAN
 		vulkan,
 #endif
+		software,
+		null,	// headless, not offered in the settings
 		max
 	};
 	static constexpr array<const char*, sizet(Renderer::max)> rendererNames = {
@@ -465,8 +474,10 @@ public:
 #endif
 #endif
 #ifdef WITH_VULKAN
-		"Vulkan 1.0"
+		"Vulkan 1.0",
 #endif
+		"Software",
+		"Headless"
 	};
 
 	static constexpr float defaultZoom = 1.f;
@@ -498,6 +509,8 @@ public:
 	vec2 scrollSpeed = vec2(1600.f, 1600.f);
 	float zoom = defaultZoom;
 	int spacing = defaultSpacing;
+	uint maxFps = 0;	// frame cap while animating, 0 for none
+	uint textureBudget = 0;	// megabytes of textures to keep around, 0 to go by the device's memory
 private:
 	int deadzone = 256;
 public:
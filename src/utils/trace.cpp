@@ -0,0 +1,51 @@
+#include "trace.h"
+#include <fstream>
+
+void Trace::start() {
+	std::lock_guard guard(lock);
+	origin = SDL_GetPerformanceCounter();
+	enabled = true;
+}
+
+void Trace::record(Zone& zone) {
+	uint64 end = SDL_GetPerformanceCounter();
+	std::lock_guard guard(lock);
+	events.push_back(Event{ zone.name, zone.start, end, SDL_ThreadID(), std::move(zone.file), zone.bytes });
+}
+
+void Trace::write(const fs::path& path) {
+	enabled = false;
+	std::lock_guard guard(lock);
+	std::ofstream ofh(path, std::ios::binary);
+	if (!ofh) {
+		logError("Failed to write trace to ", path);
+		return;
+	}
+
+	// complete events with microsecond timestamps
+	double usPerTick = 1'000'000.0 / double(SDL_GetPerformanceFrequency());
+	ofh << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for (sizet i = 0; i < events.size(); ++i) {
+		const Event& it = events[i];
+		ofh << (i ? ",\n" : "\n") << "{\"name\":\"" << it.name << "\",\"cat\":\"load\",\"ph\":\"X\",\"pid\":1,\"tid\":" << it.thread
+			<< ",\"ts\":" << toStr(double(it.start - origin) * usPerTick) << ",\"dur\":" << toStr(double(it.end - it.start) * usPerTick) << ",\"args\":{";
+		if (!it.file.empty()) {
+			ofh << "\"file\":\"";
+			for (char c : it.file) {
+				if (c == '"' || c == '\\')
+					ofh << '\\' << c;
+				else if (uint8(c) < 0x20)
+					ofh << "\\u00" << "0123456789abcdef"[uint8(c) >> 4] << "0123456789abcdef"[c & 0xF];
+				else
+					ofh << c;
+			}
+			ofh << (it.bytes ? "\"," : "\"");
+		}
+		if (it.bytes)
+			ofh << "\"bytes\":" << it.bytes;
+		ofh << "}}";
+	}
+	ofh << "\n]}\n";
+	logInfo("Wrote ", events.size(), " trace events to ", path);
+	events.clear();
+}
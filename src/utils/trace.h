@@ -0,0 +1,86 @@
+#pragma once
+
+#include "utils.h"
+#include <atomic>
+#include <mutex>
+
+// timed zones of the loading pipeline that get written out in the Chrome/Perfetto trace event format
+class Trace {
+public:
+	class Zone {
+	private:
+		const char* name;
+		uint64 start = 0;	// 0 if tracing is off
+		string file;
+		uptrt bytes = 0;
+
+	public:
+		Zone(const char* zoneName);
+		Zone(const char* zoneName, string_view fileName);
+		~Zone();
+
+		void setFile(string_view fileName);
+		void setPath(const fs::path& fileName);
+		void setBytes(uptrt size);
+
+		friend class Trace;
+	};
+
+private:
+	struct Event {
+		const char* name;
+		uint64 start, end;
+		SDL_threadID thread;
+		string file;
+		uptrt bytes;
+	};
+
+	static inline std::atomic_bool enabled = false;
+	static inline std::mutex lock;
+	static inline vector<Event> events;
+	static inline uint64 origin = 0;
+
+public:
+	static void start();
+	static void write(const fs::path& path);
+	static bool on();
+
+private:
+	static void record(Zone& zone);
+};
+
+inline bool Trace::on() {
+	return enabled.load(std::memory_order_relaxed);
+}
+
+inline Trace::Zone::Zone(const char* zoneName) :
+	name(zoneName)
+{
+	if (on())
+		start = SDL_GetPerformanceCounter();
+}
+
+inline Trace::Zone::Zone(const char* zoneName, string_view fileName) :
+	Zone(zoneName)
+{
+	setFile(fileName);
+}
+
+inline Trace::Zone::~Zone() {
+	if (start)
+		record(*this);
+}
+
+inline void Trace::Zone::setFile(string_view fileName) {
+	if (start)
+		file = fileName;
+}
+
+inline void Trace::Zone::setPath(const fs::path& fileName) {
+	if (start)
+		file = fileName.u8string();
+}
+
+inline void Trace::Zone::setBytes(uptrt size) {
+	bytes = size;
+}
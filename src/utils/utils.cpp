@@ -1,6 +1,10 @@
 #include "utils.h"
+#include <fstream>
 #ifdef _WIN32
 #include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
 #endif
 
 void pushEvent(UserEvent code, void* data1, void* data2) {
@@ -92,6 +96,35 @@ tm currentDateTime() {
 	return tim;
 }
 
+uptrt peakMemory() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? pmc.PeakWorkingSetSize : 0;
+#else
+#ifdef __linux__
+	// unlike ru_maxrss this follows resetPeakMemory
+	std::ifstream ifs("/proc/self/status");
+	for (string line; std::getline(ifs, line);)
+		if (line.compare(0, 6, "VmHWM:") == 0)
+			return toNum<uptrt>(string_view(line).substr(6)) * 1024;
+#endif
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage))
+		return 0;
+#ifdef __APPLE__
+	return uptrt(usage.ru_maxrss);	// bytes on macOS and kilobytes everywhere else
+#else
+	return uptrt(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+void resetPeakMemory() {
+#ifdef __linux__
+	std::ofstream("/proc/self/clear_refs") << '5';
+#endif
+}
+
 #ifdef _WIN32
 string swtos(wstring_view src) {
 	string dst;
@@ -11,6 +11,7 @@
 #include <array>
 #include <charconv>
 #include <climits>
+#include <cstddef>
 #include <cstring>
 #include <filesystem>
 #include <memory>
@@ -72,6 +73,7 @@ using glm::u32vec2;
 using glm::ivec2;
 using glm::vec4;
 using glm::u8vec4;
+using glm::u16vec4;
 using glm::ivec4;
 using mvec2 = glm::vec<2, sizet, glm::defaultp>;
 
@@ -85,7 +87,10 @@ class ComboBox;
 class Context;
 class DrawSys;
 class FileSys;
+class FrameStats;
 class InputSys;
+class InputTrace;
+class MemoryGovernor;
 class Label;
 class LabelEdit;
 class Layout;
@@ -97,12 +102,15 @@ class Program;
 class ProgressBar;
 class ProgState;
 class ReaderBox;
+struct ResidentTexture;
 class RootLayout;
 class Scene;
 class ScrollArea;
 class Settings;
+struct Size;
 class Slider;
 class Texture;
+struct Tooltip;
 class Widget;
 class WindowArranger;
 
@@ -124,6 +132,7 @@ constexpr string_view linend = "\n";
 enum UserEvent : uint32 {
 	SDL_USEREVENT_READER_PROGRESS = SDL_USEREVENT,
 	SDL_USEREVENT_READER_FINISHED,
+	SDL_USEREVENT_READER_RELOADED,
 	SDL_USEREVENT_PREVIEW_PROGRESS,
 #ifdef DOWNLOADER
 	SDL_USEREVENT_DOWNLOAD_PROGRESS,
@@ -244,6 +253,7 @@ struct Rect {
 	constexpr bool contains(const tvec2& point) const;
 	constexpr bool overlaps(const Rect& rect) const;
 	constexpr Rect<T> intersect(const Rect& rect) const;
+	constexpr Rect<T> unite(const Rect& rect) const;
 	constexpr Rect<T> translate(const tvec2& mov) const;
 };
 
@@ -350,11 +360,29 @@ constexpr Rect<T> Rect<T>::intersect(const Rect& rect) const {
 	return false;
 }
 
+template <class T>
+constexpr Rect<T> Rect<T>::unite(const Rect& rect) const {
+	if (empty())
+		return rect;
+	if (rect.empty())
+		return *this;
+	tvec2 dpos = glm::min(pos(), rect.pos());
+	return Rect(dpos, glm::max(end(), rect.end()) - dpos);
+}
+
 template <class T>
 constexpr Rect<T> Rect<T>::translate(const tvec2& mov) const {
 	return Rect(pos() + mov, size());
 }
 
+// glyphs of a line of text and their pen positions, drawn from the font's glyph atlas of the given height
+
+struct TextLine {
+	vector<pair<char32_t, int>> glyphs;
+	int height = 0;
+	int width = 0;
+};
+
 // files and strings
 
 bool isDriveLetter(const fs::path& path);
@@ -363,6 +391,8 @@ string strEnclose(string_view str);
 vector<string> strUnenclose(string_view str);
 vector<string_view> getWords(string_view str);
 tm currentDateTime();
+uptrt peakMemory();	// resident set high-water mark in bytes
+void resetPeakMemory();	// only works on Linux, elsewhere the peak covers the process' whole lifetime
 
 inline bool isSpace(int c) {
 	return (c > '\0' && c <= ' ') || c == 0x7F;
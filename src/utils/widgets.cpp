@@ -5,6 +5,50 @@
 #include "engine/world.h"
 #include "prog/progs.h"
 
+// WIDGET ARENA
+
+void* WidgetArena::allocate(sizet size) {
+	uint8* mem = current ? static_cast<uint8*>(current->push(size + headerSize)) : static_cast<uint8*>(::operator new(size + headerSize));
+	*reinterpret_cast<WidgetArena**>(mem) = current;
+	return mem + headerSize;
+}
+
+void WidgetArena::deallocate(void* ptr) {
+	if (ptr) {
+		uint8* mem = static_cast<uint8*>(ptr) - headerSize;
+		if (WidgetArena* arena = *reinterpret_cast<WidgetArena**>(mem))
+			--arena->live;
+		else
+			::operator delete(mem);
+	}
+}
+
+void* WidgetArena::push(sizet size) {
+	size = (size + headerSize - 1) / headerSize * headerSize;
+	++live;
+	if (size > blockSize) {	// gets it's own block behind the one that's being filled
+		blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, std::make_unique<uint8[]>(size));
+		return (blocks.size() > 1 ? blocks.end()[-2] : blocks.back()).get();
+	}
+	if (blockSize - blockUsed < size) {
+		blocks.push_back(std::make_unique<uint8[]>(blockSize));
+		blockUsed = 0;
+	}
+	void* mem = blocks.back().get() + blockUsed;
+	blockUsed += size;
+	return mem;
+}
+
+void WidgetArena::clear() {
+	if (live) {
+		logError("Can't clear widget arena with ", live, " widgets still alive");
+		return;
+	}
+	if (blocks.size() > 1)
+		blocks.erase(blocks.begin() + 1, blocks.end());
+	blockUsed = blocks.empty() ? blockSize : 0;
+}
+
 // WIDGET
 
 bool Widget::navSelectable() const {
@@ -81,7 +125,7 @@ Recti Picture::texRect() const {
 
 // BUTTON
 
-Button::Button(const Size& size, PCall leftCall, PCall rightCall, PCall doubleCall, Texture* tip, bool bg, const Texture* texture, int margin) :
+Button::Button(const Size& size, PCall leftCall, PCall rightCall, PCall doubleCall, Tooltip* tip, bool bg, const Texture* texture, int margin) :
 	Picture(size, bg, texture, margin),
 	lcall(leftCall),
 	rcall(rightCall),
@@ -90,8 +134,8 @@ Button::Button(const Size& size, PCall leftCall, PCall rightCall, PCall doubleCa
 {}
 
 Button::~Button() {
-	if (tooltip)
-		World::drawSys()->freeTexture(tooltip);
+	releaseCache();
+	delete tooltip;
 }
 
 void Button::onClick(ivec2, uint8 mBut) {
@@ -117,6 +161,13 @@ bool Button::hasDoubleclick() const {
 	return dcall;
 }
 
+void Button::releaseCache() {
+	if (tooltip && tooltip->tex) {
+		World::drawSys()->freeTexture(tooltip->tex);
+		tooltip->tex = nullptr;
+	}
+}
+
 Color Button::color() const {
 	if (parent->getSelected().count(const_cast<Button*>(this)))
 		return Color::light;
@@ -126,12 +177,16 @@ Color Button::color() const {
 }
 
 const Texture* Button::getTooltip() {
-	return tooltip;
+	if (!tooltip || !World::sets()->tooltips)
+		return nullptr;
+	if (!tooltip->tex)
+		tooltip->tex = World::drawSys()->renderText(tooltip->text, tooltip->height, tooltip->width);
+	return tooltip->tex;
 }
 
 Recti Button::tooltipRect() const {
 	ivec2 view = World::drawSys()->getViewRes();
-	Recti rct(World::winSys()->mousePos() + ivec2(0, DrawSys::cursorHeight), tooltip ? tooltip->getRes() + tooltipMargin * 2 : ivec2(0));
+	Recti rct(World::winSys()->mousePos() + ivec2(0, DrawSys::cursorHeight), tooltip && tooltip->tex ? tooltip->tex->getRes() + tooltipMargin * 2 : ivec2(0));
 	if (rct.x + rct.w > view.x)
 		rct.x = view.x - rct.w;
 	if (rct.y + rct.h > view.y)
@@ -141,7 +196,7 @@ Recti Button::tooltipRect() const {
 
 // CHECK BOX
 
-CheckBox::CheckBox(const Size& size, bool checked, PCall leftCall, PCall rightCall, PCall doubleCall, Texture* tip, bool bg, const Texture* texture, int margin) :
+CheckBox::CheckBox(const Size& size, bool checked, PCall leftCall, PCall rightCall, PCall doubleCall, Tooltip* tip, bool bg, const Texture* texture, int margin) :
 	Button(size, leftCall, rightCall, doubleCall, tip, bg, texture, margin),
 	on(checked)
 {}
@@ -164,7 +219,7 @@ Recti CheckBox::boxRect() const {
 
 // SLIDER
 
-Slider::Slider(const Size& size, int value, int minimum, int maximum, PCall leftCall, PCall rightCall, PCall doubleCall, Texture* tip, bool bg, const Texture* texture, int margin) :
+Slider::Slider(const Size& size, int value, int minimum, int maximum, PCall leftCall, PCall rightCall, PCall doubleCall, Tooltip* tip, bool bg, const Texture* texture, int margin) :
 	Button(size, leftCall, rightCall, doubleCall, tip, bg, texture, margin),
 	val(value),
 	vmin(minimum),
@@ -191,6 +246,7 @@ void Slider::onHold(ivec2 mPos, uint8 mBut) {
 
 void Slider::onDrag(ivec2 mPos, ivec2) {
 	setSlider(mPos.x - diffSliderMouse);
+	World::drawSys()->invalidate();	// the call may change anything
 }
 
 void Slider::onUndrag(uint8 mBut) {
@@ -240,42 +296,48 @@ Recti ProgressBar::barRect() const {
 
 // LABEL
 
-Label::Label(const Size& size, string line, PCall leftCall, PCall rightCall, PCall doubleCall, Texture* tip, Alignment alignment, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
+Label::Label(const Size& size, string line, PCall leftCall, PCall rightCall, PCall doubleCall, Tooltip* tip, Alignment alignment, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
 	Button(size, leftCall, rightCall, doubleCall, tip, bg, texture, iconMargin),
 	text(std::move(line)),
 	textMargin(lineMargin),
 	align(alignment)
 {}
 
-Label::~Label() {
-	if (textTex)
-		World::drawSys()->freeTexture(textTex);
-}
-
 void Label::drawSelf(const Recti& view) {
 	World::drawSys()->drawLabel(this, view);
 }
 
 void Label::onResize() {
-	updateTextTex();
+	updateTextLine();
 }
 
 void Label::postInit() {
-	updateTextTex();
+	updateTextLine();
+}
+
+void Label::releaseCache() {
+	Button::releaseCache();
+	textLine = TextLine();
 }
 
 void Label::setText(string&& str) {
 	text = std::move(str);
-	updateTextTex();
+	updateTextLine();
 }
 
 void Label::setText(const string& str) {
 	text = str;
-	updateTextTex();
+	updateTextLine();
+}
+
+const TextLine& Label::getTextLine() const {
+	if (int height = size().y; textLine.height != height)
+		textLine = World::drawSys()->layoutText(text, height);
+	return textLine;
 }
 
 Recti Label::textRect() const {
-	return Recti(textPos(), textTex->getRes());
+	return Recti(textPos(), getTextLine().width, size().y);
 }
 
 Recti Label::textFrame() const {
@@ -301,28 +363,26 @@ ivec2 Label::textPos() const {
 		return ivec2(pos.x + textIconOffset() + textMargin, pos.y);
 	case Alignment::center: {
 		int iofs = textIconOffset();
-		return ivec2(pos.x + iofs + (size().x - iofs - textTex->getRes().x) / 2, pos.y); }
+		return ivec2(pos.x + iofs + (size().x - iofs - getTextLine().width) / 2, pos.y); }
 	case Alignment::right:
-		return ivec2(pos.x + size().x - textTex->getRes().x - textMargin, pos.y);
+		return ivec2(pos.x + size().x - getTextLine().width - textMargin, pos.y);
 	}
 	throw std::runtime_error("Invalid alignment type: " + toStr(align));
 }
 
-void Label::updateTextTex() {
-	if (textTex)
-		World::drawSys()->freeTexture(textTex);
-	textTex = World::drawSys()->renderText(text, size().y);
+void Label::updateTextLine() {
+	textLine.height = 0;	// lay out again once it's needed
 }
 
 // COMBO BOX
 
-ComboBox::ComboBox(const Size& size, string curOption, vector<string>&& opts, PCall call, Texture* tip, Alignment alignment, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
+ComboBox::ComboBox(const Size& size, string curOption, vector<string>&& opts, PCall call, Tooltip* tip, Alignment alignment, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
 	Label(size, std::move(curOption), call, call, nullptr, tip, alignment, texture, bg, lineMargin, iconMargin),
 	options(std::move(opts)),
 	curOpt(std::min(sizet(std::find(options.begin(), options.end(), text) - options.begin()), options.size()))
 {}
 
-ComboBox::ComboBox(const Size& size, sizet curOption, vector<string>&& opts, PCall call, Texture* tip, Alignment alignment, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
+ComboBox::ComboBox(const Size& size, sizet curOption, vector<string>&& opts, PCall call, Tooltip* tip, Alignment alignment, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
 	Label(size, opts[curOption], call, call, nullptr, tip, alignment, texture, bg, lineMargin, iconMargin),
 	options(std::move(opts)),
 	curOpt(curOption)
@@ -340,7 +400,7 @@ void ComboBox::setCurOpt(sizet id) {
 
 // LABEL EDIT
 
-LabelEdit::LabelEdit(const Size& size, string line, PCall leftCall, PCall rightCall, PCall doubleCall, Texture* tip, TextType type, bool focusLossConfirm, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
+LabelEdit::LabelEdit(const Size& size, string line, PCall leftCall, PCall rightCall, PCall doubleCall, Tooltip* tip, TextType type, bool focusLossConfirm, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
 	Label(size, std::move(line), leftCall, rightCall, doubleCall, tip, Alignment::left, texture, bg, lineMargin, iconMargin),
 	unfocusConfirm(focusLossConfirm),
 	textType(type),
@@ -387,29 +447,29 @@ void LabelEdit::onKeypress(const SDL_Keysym& key) {
 		if (kmodAlt(key.mod)) {	// if holding alt delete left word
 			uint id = findWordStart();
 			text.erase(id, cpos - id);
-			updateTextTex();
+			updateTextLine();
 			setCPos(id);
 		} else if (kmodCtrl(key.mod)) {	// if holding ctrl delete line to left
 			text.erase(0, cpos);
-			updateTextTex();
+			updateTextLine();
 			setCPos(0);
 		} else if (cpos > 0) {	// otherwise delete left character
 			uint id = jumpCharB(cpos);
 			text.erase(id, cpos - id);
-			updateTextTex();
+			updateTextLine();
 			setCPos(id);
 		}
 		break;
 	case SDL_SCANCODE_DELETE:	// delete right character
 		if (kmodAlt(key.mod)) {	// if holding alt delete right word
 			text.erase(cpos, findWordEnd() - cpos);
-			updateTextTex();
+			updateTextLine();
 		} else if (kmodCtrl(key.mod)) {	// if holding ctrl delete line to right
 			text.erase(cpos, text.length() - cpos);
-			updateTextTex();
+			updateTextLine();
 		} else if (cpos < text.length()) {	// otherwise delete right character
 			text.erase(cpos, jumpCharF(cpos) - cpos);
-			updateTextTex();
+			updateTextLine();
 		}
 		break;
 	case SDL_SCANCODE_HOME:	// move caret to beginning
@@ -451,14 +511,14 @@ void LabelEdit::onKeypress(const SDL_Keysym& key) {
 void LabelEdit::onCompose(string_view str, uint olen) {
 	text.erase(cpos, olen);
 	text.insert(cpos, str);
-	updateTextTex();
+	updateTextLine();
 }
 
 void LabelEdit::onText(string_view str, uint olen) {
 	text.erase(cpos, olen);
 	text.insert(cpos, str.data(), str.length());
 	cleanText();
-	updateTextTex();
+	updateTextLine();
 	setCPos(cpos + str.length());
 }
 
@@ -481,7 +541,7 @@ void LabelEdit::setText(const string& str) {
 
 void LabelEdit::onTextReset() {
 	cleanText();
-	updateTextTex();
+	updateTextLine();
 	setCPos(text.length());
 }
 
@@ -507,7 +567,7 @@ void LabelEdit::confirm() {
 void LabelEdit::cancel() {
 	textOfs = 0;
 	text = oldText;
-	updateTextTex();
+	updateTextLine();
 
 	World::scene()->setCapture(nullptr);
 	SDL_StopTextInput();
@@ -680,7 +740,7 @@ void LabelEdit::cleanUFloatSpacedText() {
 
 // KEY GETTER
 
-KeyGetter::KeyGetter(const Size& size, AcceptType type, Binding::Type binding, Texture* tip, Alignment alignment, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
+KeyGetter::KeyGetter(const Size& size, AcceptType type, Binding::Type binding, Tooltip* tip, Alignment alignment, const Texture* texture, bool bg, int lineMargin, int iconMargin) :
 	Label(size, bindingText(binding, type), nullptr, nullptr, nullptr, tip, alignment, texture, bg, lineMargin, iconMargin),
 	acceptType(type),
 	bindingType(binding)
@@ -804,7 +864,7 @@ WindowArranger::Dsp::Dsp(const Recti& vdsp, bool on) :
 	active(on)
 {}
 
-WindowArranger::WindowArranger(const Size& size, float baseScale, bool vertExp, PCall leftCall, PCall rightCall, Texture* tip, bool bg, const Texture* texture, int margin) :
+WindowArranger::WindowArranger(const Size& size, float baseScale, bool vertExp, PCall leftCall, PCall rightCall, Tooltip* tip, bool bg, const Texture* texture, int margin) :
 	Button(size, leftCall, rightCall, nullptr, tip, bg, texture, margin),
 	bscale(baseScale),
 	vertical(vertExp)
@@ -880,7 +940,10 @@ void WindowArranger::onClick(ivec2 mPos, uint8 mBut) {
 }
 
 void WindowArranger::onMouseMove(ivec2 mPos, ivec2) {
-	selected = dispUnderPos(mPos);
+	if (int sel = dispUnderPos(mPos); sel != selected) {
+		selected = sel;
+		World::drawSys()->invalidate(this);
+	}
 }
 
 void WindowArranger::onHold(ivec2 mPos, uint8 mBut) {
@@ -894,6 +957,7 @@ void WindowArranger::onHold(ivec2 mPos, uint8 mBut) {
 }
 
 void WindowArranger::onDrag(ivec2 mPos, ivec2) {
+	World::drawSys()->invalidate();	// the dragged display is drawn on top of everything
 	dragr.pos() = mPos - disps.at(dragging).rect.size() / 2;
 	if (ivec2 spos = snapDrag(); spos.x >= 0 && spos.y >= 0)
 		dragr.pos() = ivec2(vec2(spos) * entryScale(size())) + position() + winMargin;
@@ -993,7 +1057,7 @@ Color WindowArranger::color() const {
 }
 
 const Texture* WindowArranger::getTooltip() {
-	return disps.count(selected) ? tooltip : nullptr;
+	return disps.count(selected) ? Button::getTooltip() : nullptr;
 }
 
 bool WindowArranger::draggingDisp(int id) const {
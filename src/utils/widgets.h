@@ -44,6 +44,48 @@ inline int Size::operator()(const Widget* wgt) const {
 	return cfn(wgt);
 }
 
+// bump allocator that keeps the widgets of a layout next to each other so they can be released together
+class WidgetArena {
+public:
+	// widgets created while a scope is alive go into it's arena
+	class Scope {
+	private:
+		WidgetArena* prev;
+
+	public:
+		Scope(WidgetArena& arena);
+		~Scope();
+	};
+
+private:
+	static constexpr sizet blockSize = 64 * 1024;
+	static constexpr sizet headerSize = alignof(std::max_align_t);	// each allocation starts with a pointer to it's arena
+
+	static inline WidgetArena* current = nullptr;
+
+	vector<uptr<uint8[]>> blocks;
+	sizet blockUsed = blockSize;	// bytes used in the last block
+	sizet live = 0;					// allocations that haven't been freed yet
+
+public:
+	static void* allocate(sizet size);
+	static void deallocate(void* ptr);
+	void clear();	// drops all memory at once (except for the first block to reuse) if every widget has been deleted
+
+private:
+	void* push(sizet size);
+};
+
+inline WidgetArena::Scope::Scope(WidgetArena& arena) :
+	prev(current)
+{
+	current = &arena;
+}
+
+inline WidgetArena::Scope::~Scope() {
+	current = prev;
+}
+
 // can be used as spacer
 class Widget {
 protected:
@@ -55,6 +97,9 @@ public:
 	Widget(const Size& size = Size());
 	virtual ~Widget() = default;
 
+	static void* operator new(sizet size);
+	static void operator delete(void* ptr);
+
 	virtual void drawSelf(const Recti&) {}	// calls appropriate drawing function(s) in DrawSys
 	virtual void drawTop(const Recti&) {}
 	virtual void drawAddr(const Recti&) {}
@@ -77,6 +122,7 @@ public:
 	virtual void onCompose(string_view, uint) {}
 	virtual void onText(string_view, uint) {}
 	virtual void onDisplayChange() {}
+	virtual void releaseCache() {}	// free whatever can be recreated on demand when the widget is far out of view
 	virtual void onNavSelect(Direction dir);
 	virtual bool navSelectable() const;
 	virtual bool hasDoubleclick() const;
@@ -99,6 +145,14 @@ inline Widget::Widget(const Size& size) :
 	relSize(size)
 {}
 
+inline void* Widget::operator new(sizet size) {
+	return WidgetArena::allocate(size);
+}
+
+inline void Widget::operator delete(void* ptr) {
+	WidgetArena::deallocate(ptr);
+}
+
 inline sizet Widget::getIndex() const {
 	return index;
 }
@@ -140,6 +194,22 @@ public:
 	virtual Recti texRect() const;
 };
 
+// tooltip text that only gets rendered once it's shown
+struct Tooltip {
+	string text;
+	int height;
+	uint width;	// wrap length
+	Texture* tex = nullptr;
+
+	Tooltip(string str, int lineHeight, uint length);
+};
+
+inline Tooltip::Tooltip(string str, int lineHeight, uint length) :
+	text(std::move(str)),
+	height(lineHeight),
+	width(length)
+{}
+
 // clickable widget with function calls for left and right click (it's rect is drawn so you can use it like a spacer with color)
 class Button : public Picture {
 public:
@@ -147,28 +217,41 @@ public:
 
 protected:
 	PCall lcall, rcall, dcall;
-	Texture* tooltip;
+	Tooltip* tooltip;
 
 public:
-	Button(const Size& size = Size(), PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Texture* tip = nullptr, bool bg = true, const Texture* texture = nullptr, int margin = defaultIconMargin);
+	Button(const Size& size = Size(), PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Tooltip* tip = nullptr, bool bg = true, const Texture* texture = nullptr, int margin = defaultIconMargin);
 	~Button() override;
 
 	void onClick(ivec2 mPos, uint8 mBut) override;
 	void onDoubleClick(ivec2 mPos, uint8 mBut) override;
 	bool navSelectable() const override;
 	bool hasDoubleclick() const override;
+	void releaseCache() override;
 
 	Color color() const override;
+	void setCalls(PCall leftCall, PCall rightCall = nullptr, PCall doubleCall = nullptr);
 	virtual const Texture* getTooltip();
+	const Texture* renderedTooltip() const;	// without rendering it if it isn't
 	Recti tooltipRect() const;
 };
 
+inline void Button::setCalls(PCall leftCall, PCall rightCall, PCall doubleCall) {
+	lcall = leftCall;
+	rcall = rightCall;
+	dcall = doubleCall;
+}
+
+inline const Texture* Button::renderedTooltip() const {
+	return tooltip ? tooltip->tex : nullptr;
+}
+
 // if you don't know what a checkbox is then I don't know what to tell ya
 class CheckBox : public Button {
 public:
 	bool on;
 
-	CheckBox(const Size& size = Size(), bool checked = false, PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Texture* tip = nullptr, bool bg = true, const Texture* texture = nullptr, int margin = defaultIconMargin);
+	CheckBox(const Size& size = Size(), bool checked = false, PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Tooltip* tip = nullptr, bool bg = true, const Texture* texture = nullptr, int margin = defaultIconMargin);
 	~CheckBox() final = default;
 
 	void drawSelf(const Recti& view) final;
@@ -196,7 +279,7 @@ private:
 	int diffSliderMouse = 0;
 
 public:
-	Slider(const Size& size = Size(), int value = 0, int minimum = 0, int maximum = 255, PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Texture* tip = nullptr, bool bg = true, const Texture* texture = nullptr, int margin = defaultIconMargin);
+	Slider(const Size& size = Size(), int value = 0, int minimum = 0, int maximum = 255, PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Tooltip* tip = nullptr, bool bg = true, const Texture* texture = nullptr, int margin = defaultIconMargin);
 	~Slider() final = default;
 
 	void drawSelf(const Recti& view) final;
@@ -263,22 +346,23 @@ public:
 
 protected:
 	string text;
-	Texture* textTex = nullptr;
+	mutable TextLine textLine;	// laid out on first use
 	int textMargin;
 	Alignment align;	// text alignment
 
 public:
-	Label(const Size& size = Size(), string line = string(), PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Texture* tip = nullptr, Alignment alignment = Alignment::left, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
-	~Label() override;
+	Label(const Size& size = Size(), string line = string(), PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Tooltip* tip = nullptr, Alignment alignment = Alignment::left, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
+	~Label() override = default;
 
 	void drawSelf(const Recti& view) override;
 	void onResize() override;
 	void postInit() override;
+	void releaseCache() override;
 
 	const string& getText() const;
 	virtual void setText(string&& str);
 	virtual void setText(const string& str);
-	const Texture* getTextTex() const;
+	const TextLine& getTextLine() const;
 	Recti textRect() const;
 	Recti textFrame() const;
 	Recti texRect() const override;
@@ -286,17 +370,13 @@ public:
 	int getTextMargin() const;
 protected:
 	virtual ivec2 textPos() const;
-	virtual void updateTextTex();
+	virtual void updateTextLine();
 };
 
 inline const string& Label::getText() const {
 	return text;
 }
 
-inline const Texture* Label::getTextTex() const {
-	return textTex;
-}
-
 inline int Label::getTextMargin() const {
 	return textMargin;
 }
@@ -308,8 +388,8 @@ private:
 	sizet curOpt;
 
 public:
-	ComboBox(const Size& size = Size(), string curOption = string(), vector<string>&& opts = vector<string>(), PCall call = nullptr, Texture* tip = nullptr, Alignment alignment = Alignment::left, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
-	ComboBox(const Size& size = Size(), sizet curOption = 0, vector<string>&& opts = vector<string>(), PCall call = nullptr, Texture* tip = nullptr, Alignment alignment = Alignment::left, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
+	ComboBox(const Size& size = Size(), string curOption = string(), vector<string>&& opts = vector<string>(), PCall call = nullptr, Tooltip* tip = nullptr, Alignment alignment = Alignment::left, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
+	ComboBox(const Size& size = Size(), sizet curOption = 0, vector<string>&& opts = vector<string>(), PCall call = nullptr, Tooltip* tip = nullptr, Alignment alignment = Alignment::left, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
 	~ComboBox() final = default;
 
 	void onClick(ivec2 mPos, uint8 mBut) final;
@@ -352,7 +432,7 @@ private:
 	string oldText;
 
 public:
-	LabelEdit(const Size& size = Size(), string line = string(), PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Texture* tip = nullptr, TextType type = TextType::text, bool focusLossConfirm = true, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
+	LabelEdit(const Size& size = Size(), string line = string(), PCall leftCall = nullptr, PCall rightCall = nullptr, PCall doubleCall = nullptr, Tooltip* tip = nullptr, TextType type = TextType::text, bool focusLossConfirm = true, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
 	~LabelEdit() final = default;
 
 	void drawTop(const Recti& view) final;
@@ -423,7 +503,7 @@ private:
 	Binding::Type bindingType;	// index of what is currently being edited
 
 public:
-	KeyGetter(const Size& size = Size(), AcceptType type = AcceptType::keyboard, Binding::Type binding = Binding::Type(-1), Texture* tip = nullptr, Alignment alignment = Alignment::center, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
+	KeyGetter(const Size& size = Size(), AcceptType type = AcceptType::keyboard, Binding::Type binding = Binding::Type(-1), Tooltip* tip = nullptr, Alignment alignment = Alignment::center, const Texture* texture = nullptr, bool bg = true, int lineMargin = defaultTextMargin, int iconMargin = defaultIconMargin);
 	~KeyGetter() final = default;
 
 	void onClick(ivec2 mPos, uint8 mBut) final;
@@ -473,7 +553,7 @@ private:
 	bool vertical;
 
 public:
-	WindowArranger(const Size& size = Size(), float baseScale = 1.f, bool vertExp = true, PCall leftCall = nullptr, PCall rightCall = nullptr, Texture* tip = nullptr, bool bg = true, const Texture* texture = nullptr, int margin = defaultIconMargin);
+	WindowArranger(const Size& size = Size(), float baseScale = 1.f, bool vertExp = true, PCall leftCall = nullptr, PCall rightCall = nullptr, Tooltip* tip = nullptr, bool bg = true, const Texture* texture = nullptr, int margin = defaultIconMargin);
 	~WindowArranger() final;
 
 	void drawSelf(const Recti& view) final;